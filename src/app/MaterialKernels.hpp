@@ -0,0 +1,292 @@
+#pragma once
+#include "../grid/Grid.hpp"
+#include "../particle/Material.hpp"
+#include "../core/utils/CounterRng.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+/**
+ * @brief Per-material update kernels and their compile-time dispatch table
+ *
+ * Each MovementClass has a kernel template instantiated for the caller's
+ * grid type (any BasicGrid storage policy) and move functor.
+ * makeKernelTable() maps every ParticleType to its kernel through the
+ * MATERIALS registry, so the simulation loop dispatches with a single
+ * indexed call instead of nested switches.
+ *
+ * Neighbour tests go through Grid::isOccupied(), whose occupancy guard ring
+ * reads cells one step outside the grid as walls, so the kernels carry no
+ * x > 0 / x < width - 1 branches. The bottom row stays inert, as before.
+ *
+ * Usage:
+ * @code
+ * auto move = [&](uint32_t fx, uint32_t fy, uint32_t tx, uint32_t ty) { ... };
+ * CounterRng rng(seed, frame);
+ * stepParticle(grid, x, y, rng, move);
+ * @endcode
+ *
+ * @see Material, SimulationEngine
+ */
+namespace kernels {
+
+// Cells per tick added to the vertical velocity of falling particles
+constexpr int GRAVITY = 1;
+
+// Terminal velocity in cells per tick. A particle reaches at most this far
+// outside its chunk, so it must stay below half a chunk for the checkerboard
+// phases to remain disjoint.
+constexpr int MAX_VELOCITY = 8;
+static_assert(MAX_VELOCITY < static_cast<int>(ChunkTracker::CHUNK_SIZE / 2),
+              "Particles must not reach past half a chunk per tick");
+
+/**
+ * @brief Walks the Bresenham line from (x, y) towards (x + dx, y + dy)
+ * @param outX Last free cell reached (x if none)
+ * @param outY Last free cell reached (y if none)
+ * @return Number of free cells travelled before the first obstacle or edge
+ * @note The path stops at the first occupied cell, so it steps at most one
+ *       cell outside the grid, into the occupancy guard ring
+ */
+template<typename GridT>
+int traceFreePath(const GridT& grid, uint32_t x, uint32_t y, int dx, int dy,
+                  uint32_t& outX, uint32_t& outY) {
+    int adx = std::abs(dx);
+    int ady = std::abs(dy);
+    int sx = dx < 0 ? -1 : 1;
+    int sy = dy < 0 ? -1 : 1;
+    int err = adx - ady;
+    int cx = static_cast<int>(x);
+    int cy = static_cast<int>(y);
+    int travelled = 0;
+    
+    for (int i = 0; i < std::max(adx, ady); i++) {
+        int nx = cx;
+        int ny = cy;
+        int e2 = 2 * err;
+        if (e2 > -ady) { err -= ady; nx += sx; }
+        if (e2 < adx)  { err += adx; ny += sy; }
+        
+        if (grid.isOccupied(nx, ny)) {
+            break;
+        }
+        cx = nx;
+        cy = ny;
+        travelled++;
+    }
+    
+    outX = cx;
+    outY = cy;
+    return travelled;
+}
+
+/**
+ * @brief Accelerates a particle and moves it along its velocity
+ * @return true if the particle moved
+ * @note Travels up to MAX_VELOCITY cells with a single move; velocity is
+ *       reset when the path is cut short by an obstacle
+ */
+template<typename GridT, typename MoveFn>
+bool fall(GridT& grid, uint32_t x, uint32_t y, MoveFn& tryMove) {
+    auto&& p = grid.atUnchecked(x, y);
+    int vx = p.getVelocityX();
+    int vy = std::min(p.getVelocityY() + GRAVITY, MAX_VELOCITY);
+    
+    uint32_t targetX;
+    uint32_t targetY;
+    if (traceFreePath(grid, x, y, vx, vy, targetX, targetY) == 0) {
+        p.setVelocity(0, 0);
+        return false;
+    }
+    
+    bool landed = targetX != x + vx || targetY != y + vy;
+    p.setVelocity(landed ? 0 : vx, landed ? 0 : vy);
+    return tryMove(x, y, targetX, targetY);
+}
+
+static_assert(ChunkTracker::CHUNK_SIZE == OccupancyBitboard::WORD_BITS,
+              "Chunk column cx must map to occupancy word column cx");
+
+/**
+ * @brief Occupied cells of word (wx, y) that have at least one free neighbour
+ *
+ * Tests the five cells a particle can move into (below, both diagonals
+ * below, left, right) for 64 cells at once. Cells outside the returned mask
+ * are empty or fully enclosed, so no kernel could move them this tick.
+ * Enclosed particles keep their velocity until they are free to move again.
+ */
+inline uint64_t mobileMask(const OccupancyBitboard& occ, int64_t wx, int64_t y) {
+    uint64_t row = occ.word(wx, y);
+    uint64_t below = occ.word(wx, y + 1);
+    
+    // Shift neighbours onto the bit of the cell they are adjacent to,
+    // carrying the edge bit in from the neighbouring word
+    uint64_t left = (row << 1) | (occ.word(wx - 1, y) >> 63);
+    uint64_t right = (row >> 1) | (occ.word(wx + 1, y) << 63);
+    uint64_t belowLeft = (below << 1) | (occ.word(wx - 1, y + 1) >> 63);
+    uint64_t belowRight = (below >> 1) | (occ.word(wx + 1, y + 1) << 63);
+    
+    return row & ~(below & belowLeft & belowRight & left & right);
+}
+
+/** @brief Bits lo..hi (inclusive) of a word */
+inline uint64_t spanMask(uint32_t lo, uint32_t hi) {
+    return (~0ULL >> (63 - hi)) & (~0ULL << lo);
+}
+
+/**
+ * @brief Whether the particle at (x, y) has a cell its kernel could move into
+ * @note Used to keep unsettled particles (e.g. a liquid that picked a
+ *       blocked direction) in the active list when nothing around them changes
+ */
+template<typename GridT>
+bool hasFreeTarget(const GridT& grid, uint32_t x, uint32_t y) {
+    MovementClass movement = getMaterial(grid.atUnchecked(x, y).type).movement;
+    if (movement == MovementClass::STATIC || y >= grid.getHeight() - 1) {
+        return false;
+    }
+    
+    if (!grid.isOccupied(x, y + 1) || !grid.isOccupied(x - 1, y + 1) ||
+        !grid.isOccupied(x + 1, y + 1)) {
+        return true;
+    }
+    return movement == MovementClass::LIQUID &&
+           (!grid.isOccupied(x - 1, y) || !grid.isOccupied(x + 1, y));
+}
+
+template<MovementClass M>
+struct MovementKernel;
+
+/** @brief Static materials never move */
+template<>
+struct MovementKernel<MovementClass::STATIC> {
+    template<typename GridT, typename MoveFn>
+    static void step(GridT&, uint32_t, uint32_t, const CounterRng&, MoveFn&) {}
+};
+
+/** @brief Powders fall along their velocity, then slide down diagonals */
+template<>
+struct MovementKernel<MovementClass::POWDER> {
+    template<typename GridT, typename MoveFn>
+    static bool slide(GridT& grid, uint32_t x, uint32_t y, MoveFn& tryMove) {
+        if (!grid.isOccupied(x - 1, y + 1)) {
+            return tryMove(x, y, x - 1, y + 1);
+        }
+        if (!grid.isOccupied(x + 1, y + 1)) {
+            return tryMove(x, y, x + 1, y + 1);
+        }
+        return false;
+    }
+
+    template<typename GridT, typename MoveFn>
+    static void step(GridT& grid, uint32_t x, uint32_t y, const CounterRng&, MoveFn& tryMove) {
+        if (!fall(grid, x, y, tryMove)) {
+            slide(grid, x, y, tryMove);
+        }
+    }
+};
+
+/** @brief Liquids behave like powders and also spread sideways */
+template<>
+struct MovementKernel<MovementClass::LIQUID> {
+    template<typename GridT, typename MoveFn>
+    static void step(GridT& grid, uint32_t x, uint32_t y, const CounterRng& rng, MoveFn& tryMove) {
+        if (fall(grid, x, y, tryMove) ||
+            MovementKernel<MovementClass::POWDER>::slide(grid, x, y, tryMove)) {
+            return;
+        }
+        
+        // Randomly choose direction; the draw depends only on the seed,
+        // frame and cell, so it is the same on every thread and replay
+        bool goLeft = rng.coin(x, y);
+        
+        if (goLeft && !grid.isOccupied(x - 1, y)) {
+            tryMove(x, y, x - 1, y);
+        } else if (!goLeft && !grid.isOccupied(x + 1, y)) {
+            tryMove(x, y, x + 1, y);
+        }
+    }
+};
+
+template<typename GridT, typename MoveFn>
+using KernelFn = void (*)(GridT&, uint32_t, uint32_t, const CounterRng&, MoveFn&);
+
+template<typename GridT, typename MoveFn>
+constexpr KernelFn<GridT, MoveFn> kernelFor(MovementClass movement) {
+    switch (movement) {
+        case MovementClass::POWDER:
+            return &MovementKernel<MovementClass::POWDER>::template step<GridT, MoveFn>;
+        case MovementClass::LIQUID:
+            return &MovementKernel<MovementClass::LIQUID>::template step<GridT, MoveFn>;
+        case MovementClass::STATIC:
+        default:
+            return &MovementKernel<MovementClass::STATIC>::template step<GridT, MoveFn>;
+    }
+}
+
+/** @brief Builds the ParticleType -> kernel jump table at compile time */
+template<typename GridT, typename MoveFn>
+constexpr std::array<KernelFn<GridT, MoveFn>, MATERIALS.size()> makeKernelTable() {
+    std::array<KernelFn<GridT, MoveFn>, MATERIALS.size()> table{};
+    for (size_t i = 0; i < MATERIALS.size(); i++) {
+        table[i] = kernelFor<GridT, MoveFn>(MATERIALS[i].movement);
+    }
+    return table;
+}
+
+/**
+ * @brief Applies one tick of physics to the particle at (x, y)
+ * @param rng Random numbers for this step (seed and frame)
+ * @param tryMove Callable (fromX, fromY, toX, toY) -> bool that performs the move
+ * @note Reads at most MAX_VELOCITY cells away from (x, y), which is what
+ *       makes the checkerboard chunk schedule safe without locks
+ */
+template<typename GridT, typename MoveFn>
+void stepParticle(GridT& grid, uint32_t x, uint32_t y, const CounterRng& rng, MoveFn& tryMove) {
+    static constexpr auto table = makeKernelTable<GridT, MoveFn>();
+    
+    // Only the type is read here, so SoA grids touch a single plane
+    ParticleType type = grid.atUnchecked(x, y).type;
+    if (type == ParticleType::EMPTY || y >= grid.getHeight() - 1) return;
+    
+    table[static_cast<size_t>(type)](grid, x, y, rng, tryMove);
+}
+
+/**
+ * @brief Steps the movable particles of one chunk's row span
+ * @param cx Chunk column; its span is occupancy word cx
+ * @param skip Cells of the span to leave alone, e.g. particles that already
+ *        moved this tick
+ * @return Cells of the span whose particle stayed put but still has a free
+ *         target (see hasFreeTarget()); the caller keeps them awake
+ * @note Enclosed and empty cells are filtered 64 at a time by mobileMask(),
+ *       so only candidates are loaded and dispatched
+ */
+template<typename GridT, typename MoveFn>
+uint64_t stepChunkRow(GridT& grid, uint32_t cx, const ChunkRect& rect, uint32_t y,
+                      const CounterRng& rng, MoveFn& tryMove, uint64_t skip = 0) {
+    uint64_t candidates = mobileMask(grid.getOccupancy(), cx, y) & ~skip &
+                          spanMask(rect.min_x % OccupancyBitboard::WORD_BITS,
+                                   rect.max_x % OccupancyBitboard::WORD_BITS);
+    uint32_t baseX = cx * OccupancyBitboard::WORD_BITS;
+    uint64_t unsettled = 0;
+    
+    bool moved = false;
+    auto track = [&](uint32_t fromX, uint32_t fromY, uint32_t toX, uint32_t toY) {
+        moved = tryMove(fromX, fromY, toX, toY);
+        return moved;
+    };
+    
+    while (candidates) {
+        uint32_t bit = __builtin_ctzll(candidates);
+        candidates &= candidates - 1;
+        moved = false;
+        stepParticle(grid, baseX + bit, y, rng, track);
+        if (!moved && hasFreeTarget(grid, baseX + bit, y)) {
+            unsettled |= 1ULL << bit;
+        }
+    }
+    return unsettled;
+}
+
+} // namespace kernels
@@ -1,14 +1,12 @@
 #pragma once
-#include "../spatial/grid_spatial_connector.hpp"
+#include "SimulationEngine.hpp"
 #include "../ui/GridVisualizer.hpp"
 #include <memory>
 #include <string>
 
 class SandSimulation {
 private:
-    std::unique_ptr<Grid> grid;
-    std::unique_ptr<SpatialHash> spatialHash;
-    std::unique_ptr<GridSpatialConnector> connector;
+    std::unique_ptr<SimulationEngine> engine;
     std::unique_ptr<GridOperations> gridOps;
     std::unique_ptr<GridVisualizer> visualizer;
     
@@ -32,11 +30,9 @@ public:
         uint32_t gridHeight = windowHeight / cellSize;
         
         // Initialize components
-        grid = std::make_unique<Grid>(gridWidth, gridHeight);
-        spatialHash = std::make_unique<SpatialHash>();
-        gridOps = std::make_unique<GridOperations>(*grid);
-        connector = std::make_unique<GridSpatialConnector>(*grid, *spatialHash);
-        visualizer = std::make_unique<GridVisualizer>(*grid, *gridOps, windowWidth, windowHeight, cellSize);
+        engine = std::make_unique<SimulationEngine>(gridWidth, gridHeight);
+        gridOps = std::make_unique<GridOperations>(engine->getGrid());
+        visualizer = std::make_unique<GridVisualizer>(engine->getGrid(), *gridOps, windowWidth, windowHeight, cellSize);
     }
     
     void run() {
@@ -54,6 +50,8 @@ public:
     void render();
     
     void addParticlesInRadius(int centerX, int centerY, int radius);
+    void eraseParticlesInRadius(int centerX, int centerY, int radius);
     void setParticleType(ParticleType type) { currentParticleType = type; }
     void setBrushSize(int size) { brushSize = size; }
+    void setParallelUpdate(bool enabled) { engine->setParallelUpdate(enabled); }
 };
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "Scene.hpp"
+#include "SimulationEngine.hpp"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+ParticleType typeFromChar(char c) {
+    switch (c) {
+        case 's': return ParticleType::SAND;
+        case 'w': return ParticleType::WATER;
+        case '#': return ParticleType::STONE;
+        case 'o': return ParticleType::WOOD;
+        default:  return ParticleType::EMPTY;
+    }
+}
+
+char charFromType(ParticleType type) {
+    switch (type) {
+        case ParticleType::SAND:  return 's';
+        case ParticleType::WATER: return 'w';
+        case ParticleType::STONE: return '#';
+        case ParticleType::WOOD:  return 'o';
+        default:                  return '.';
+    }
+}
+
+} // namespace
+
+Scene Scene::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Scene file could not be opened: " + path);
+    }
+
+    std::vector<std::string> rows;
+    std::string line;
+    size_t maxWidth = 0;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] == '%') continue;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        maxWidth = std::max(maxWidth, line.size());
+        rows.push_back(line);
+    }
+
+    if (rows.empty() || maxWidth == 0) {
+        throw std::runtime_error("Scene file is empty: " + path);
+    }
+
+    Scene scene(static_cast<uint32_t>(maxWidth), static_cast<uint32_t>(rows.size()));
+    for (uint32_t y = 0; y < rows.size(); y++) {
+        for (uint32_t x = 0; x < rows[y].size(); x++) {
+            scene.set(x, y, typeFromChar(rows[y][x]));
+        }
+    }
+    return scene;
+}
+
+Scene Scene::generate(const std::string& name, uint32_t w, uint32_t h,
+                      uint32_t seed, float density) {
+    Scene scene(w, h);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+    if (name == "rain") {
+        // Random sand and water in the upper half over a stone floor
+        for (uint32_t y = 0; y < h / 2; y++) {
+            for (uint32_t x = 0; x < w; x++) {
+                if (chance(rng) < density) {
+                    scene.set(x, y, chance(rng) < 0.5f ? ParticleType::SAND : ParticleType::WATER);
+                }
+            }
+        }
+        for (uint32_t x = 0; x < w; x++) {
+            scene.set(x, h - 1, ParticleType::STONE);
+        }
+    } else if (name == "settled") {
+        // Mostly resting material with a thin layer still falling
+        for (uint32_t y = h / 2; y < h; y++) {
+            for (uint32_t x = 0; x < w; x++) {
+                scene.set(x, y, ParticleType::SAND);
+            }
+        }
+        for (uint32_t x = 0; x < w; x++) {
+            if (chance(rng) < density) {
+                scene.set(x, h / 8, ParticleType::SAND);
+            }
+        }
+    } else {
+        throw std::invalid_argument("Unknown scene generator: " + name);
+    }
+    return scene;
+}
+
+void Scene::applyTo(SimulationEngine& engine) const {
+    uint32_t w = std::min(width, engine.getGrid().getWidth());
+    uint32_t h = std::min(height, engine.getGrid().getHeight());
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            ParticleType type = get(x, y);
+            if (type != ParticleType::EMPTY) {
+                engine.addParticle(x, y, type);
+            }
+        }
+    }
+}
+
+Scene Scene::capture(const SimulationEngine& engine) {
+    const Grid& grid = engine.getGrid();
+    Scene scene(grid.getWidth(), grid.getHeight());
+    ChunkRect all;
+    all.expand(0, 0, scene.width - 1, scene.height - 1);
+    scene.captureRects(engine, {all});
+    return scene;
+}
+
+void Scene::captureRects(const SimulationEngine& engine, const std::vector<ChunkRect>& rects) {
+    const Grid& grid = engine.getGrid();
+    for (const ChunkRect& rect : rects) {
+        for (uint32_t y = rect.min_y; y <= rect.max_y; y++) {
+            for (uint32_t x = rect.min_x; x <= rect.max_x; x++) {
+                set(x, y, grid.atUnchecked(x, y).type);
+            }
+        }
+    }
+}
+
+void Scene::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Scene file could not be written: " + path);
+    }
+
+    std::string line(width, '.');
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            line[x] = charFromType(get(x, y));
+        }
+        file << line << '\n';
+    }
+    if (!file) {
+        throw std::runtime_error("Scene file could not be written: " + path);
+    }
+}
+
+size_t Scene::getParticleCount() const {
+    return static_cast<size_t>(std::count_if(cells.begin(), cells.end(),
+        [](ParticleType t) { return t != ParticleType::EMPTY; }));
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "../particle/Particle.hpp"
+#include "../grid/ChunkTracker.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class SimulationEngine;
+
+/**
+ * @brief Initial particle layout for a simulation run
+ *
+ * Scenes are either loaded from a plain-text file or generated
+ * procedurally, then copied into a SimulationEngine of matching size.
+ * They double as snapshots: capture() copies an engine's grid, and
+ * captureRects() refreshes only the chunk rectangles a step dirtied.
+ *
+ * Text format (one line per grid row, '%' starts a comment line):
+ * - '.' or ' ': empty
+ * - 's': sand
+ * - 'w': water
+ * - '#': stone
+ * - 'o': wood
+ *
+ * Usage Examples:
+ * @code
+ * Scene scene = Scene::generate("rain", 2000, 2000, 42);
+ * SimulationEngine engine(scene.getWidth(), scene.getHeight());
+ * scene.applyTo(engine);
+ *
+ * // Incremental snapshot kept current from the dirty rectangles
+ * Scene snapshot = Scene::capture(engine);
+ * engine.step();
+ * snapshot.captureRects(engine, engine.getLastDirtyRects());
+ * snapshot.save("frame.txt");
+ * @endcode
+ *
+ * Generators:
+ * - "rain": Random sand and water in the upper half over a stone floor
+ * - "settled": Packed sand in the lower half with a thin falling layer
+ *
+ * @see SimulationEngine
+ */
+class Scene {
+private:
+    uint32_t width;
+    uint32_t height;
+    std::vector<ParticleType> cells;
+
+public:
+    Scene(uint32_t w, uint32_t h)
+        : width(w)
+        , height(h)
+        , cells(static_cast<size_t>(w) * h, ParticleType::EMPTY)
+    {}
+
+    /**
+     * @brief Loads a scene from a text file
+     * @throws std::runtime_error if the file cannot be read or is empty
+     */
+    static Scene load(const std::string& path);
+
+    /**
+     * @brief Builds a procedural scene
+     * @param name Generator name ("rain" or "settled")
+     * @throws std::invalid_argument for unknown generator names
+     */
+    static Scene generate(const std::string& name, uint32_t w, uint32_t h,
+                          uint32_t seed, float density = 0.5f);
+
+    /** @brief Adds every non-empty cell to the engine */
+    void applyTo(SimulationEngine& engine) const;
+
+    /** @brief Copies the particle types of the engine's whole grid */
+    static Scene capture(const SimulationEngine& engine);
+
+    /**
+     * @brief Copies only the given rectangles from the engine's grid
+     * @note The scene must match the grid size; cells outside the
+     *       rectangles keep their previous contents
+     */
+    void captureRects(const SimulationEngine& engine, const std::vector<ChunkRect>& rects);
+
+    /**
+     * @brief Writes the scene in the text format read by load()
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& path) const;
+
+    void set(uint32_t x, uint32_t y, ParticleType type) {
+        cells[static_cast<size_t>(y) * width + x] = type;
+    }
+
+    ParticleType get(uint32_t x, uint32_t y) const {
+        return cells[static_cast<size_t>(y) * width + x];
+    }
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    size_t getParticleCount() const;
+};
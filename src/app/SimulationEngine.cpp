@@ -0,0 +1,271 @@
+#include "SimulationEngine.hpp"
+#include "MaterialKernels.hpp"
+#include <cmath>
+#include <omp.h>
+
+using kernels::stepChunkRow;
+using kernels::stepParticle;
+
+namespace {
+
+// Particles that stayed put but could still move (a liquid whose coin flip
+// picked a blocked side) keep their chunk pending, so it does not fall
+// asleep with them unsettled
+void keepUnsettledAwake(ChunkTracker& chunks, uint32_t cx, uint32_t y, uint64_t unsettled) {
+    while (unsettled) {
+        uint32_t bit = __builtin_ctzll(unsettled);
+        unsettled &= unsettled - 1;
+        chunks.markActive(cx * ChunkTracker::CHUNK_SIZE + bit, y);
+    }
+}
+
+} // namespace
+
+void SimulationEngine::step() {
+    // Apply physics and update the grid
+    // Only chunks that changed during the previous tick are scanned
+    lastStepStats = StepStats{};
+    CounterRng rng(seed, frame);
+    lastStepStats.awake_chunks = grid->stepChunks();
+    
+    switch (updateMode) {
+        case UpdateMode::CHECKERBOARD: updateChunksParallel(rng); break;
+        case UpdateMode::ACTIVE_LIST:  updateActiveList(rng); break;
+        case UpdateMode::CHUNKED:
+        default:                       updateChunksSerial(rng); break;
+    }
+    
+    // Apply this step's moves and edits to the spatial hash as deltas.
+    // The chunk dirty rectangles are kept for the renderer and snapshot
+    // writers, then the dirty cells are cleared.
+    if (spatialSync) {
+        connector->update();
+    } else {
+        connector->discardDeltas();
+    }
+    if (cellIndex) {
+        cellIndex->rebuild(*grid);
+    }
+    grid->getDirtyRects(lastDirtyRects);
+    grid->clearDirtyStates();
+    frame++;
+}
+
+void SimulationEngine::updateChunksSerial(const CounterRng& rng) {
+    uint32_t height = grid->getHeight();
+    ChunkTracker& chunks = grid->getChunks();
+    auto move = [this](uint32_t fromX, uint32_t fromY, uint32_t toX, uint32_t toY) {
+        bool moved = connector->moveParticle(fromX, fromY, toX, toY);
+        lastStepStats.moves += moved;
+        return moved;
+    };
+    
+    // Process from bottom to top for better gravity simulation. Rows are
+    // still visited globally bottom-to-top; sleeping chunks are skipped.
+    for (int cy = static_cast<int>(chunks.getChunksY()) - 1; cy >= 0; cy--) {
+        int bandTop = cy * ChunkTracker::CHUNK_SIZE;
+        int bandBottom = std::min<int>(bandTop + ChunkTracker::CHUNK_SIZE, height - 1) - 1;
+        
+        for (int y = bandBottom; y >= bandTop; y--) {
+            for (uint32_t cx = 0; cx < chunks.getChunksX(); cx++) {
+                const ChunkRect& rect = chunks.getActiveRect(cx, cy);
+                if (rect.isEmpty() || !rect.containsRow(y)) continue;
+                
+                lastStepStats.cells_visited += rect.max_x - rect.min_x + 1;
+                keepUnsettledAwake(chunks, cx, y, stepChunkRow(*grid, cx, rect, y, rng, move));
+            }
+        }
+    }
+}
+
+void SimulationEngine::updateChunksParallel(const CounterRng& rng) {
+    uint32_t width = grid->getWidth();
+    ChunkTracker& chunks = grid->getChunks();
+    
+    uint32_t chunksX = chunks.getChunksX();
+    
+    int num_threads = omp_get_max_threads();
+    threadMoveLogs.resize(num_threads);
+    threadUnsettledLogs.resize(num_threads);
+    movedMask.resize(static_cast<size_t>(grid->getHeight()) * chunksX);
+    
+    // Chunk rows from bottom to top, as in the serial scan, so material
+    // falling into the row below finds it already stepped. Each row runs as
+    // two phases, even then odd columns: chunks processed together are never
+    // adjacent, and a particle reaches at most MAX_VELOCITY cells, under half
+    // a chunk (static_assert in MaterialKernels.hpp), into a neighbour. Two
+    // chunks of a phase therefore never touch the same cells.
+    for (int cy = static_cast<int>(chunks.getChunksY()) - 1; cy >= 0; cy--) {
+        for (uint32_t phaseX = 0; phaseX < 2; phaseX++) {
+            phaseChunks.clear();
+            for (uint32_t cx = phaseX; cx < chunksX; cx += 2) {
+                if (chunks.isAwake(cx, cy)) {
+                    const ChunkRect& rect = chunks.getActiveRect(cx, cy);
+                    lastStepStats.cells_visited += static_cast<uint64_t>(rect.max_x - rect.min_x + 1) *
+                                                   (rect.max_y - rect.min_y + 1);
+                    phaseChunks.emplace_back(cx, cy);
+                }
+            }
+            if (phaseChunks.empty()) continue;
+            
+            #pragma omp parallel for schedule(dynamic)
+            for (size_t i = 0; i < phaseChunks.size(); i++) {
+                auto& log = threadMoveLogs[omp_get_thread_num()];
+                auto& unsettledLog = threadUnsettledLogs[omp_get_thread_num()];
+                auto move = [&](uint32_t fromX, uint32_t fromY, uint32_t toX, uint32_t toY) {
+                    if (grid->isOccupied(toX, toY)) {
+                        return false;
+                    }
+                    grid->swapUntracked(fromX, fromY, toX, toY);
+                    log.push_back(fromY * width + fromX);
+                    log.push_back(toY * width + toX);
+                    return true;
+                };
+                
+                uint32_t cx = phaseChunks[i].first;
+                const ChunkRect& rect = chunks.getActiveRect(cx, phaseChunks[i].second);
+                for (int y = rect.max_y; y >= static_cast<int>(rect.min_y); y--) {
+                    uint64_t unsettled = stepChunkRow(*grid, cx, rect, y, rng, move,
+                                                      movedMask[y * chunksX + cx]);
+                    if (unsettled) {
+                        unsettledLog.emplace_back(y * chunksX + cx, unsettled);
+                    }
+                }
+            }
+            
+            // Dirty and chunk tracking are not thread-safe; apply the marks
+            // here. Moves go to the delta log phase by phase, since a particle
+            // pushed by a later phase's move is a separate move. Destinations
+            // are marked so a particle that crossed into a chunk of a later
+            // phase is not stepped twice in one tick.
+            ParticleDeltaLog& deltas = connector->getDeltaLog();
+            for (auto& log : threadMoveLogs) {
+                lastStepStats.moves += log.size() / 2;
+                for (size_t m = 0; m < log.size(); m += 2) {
+                    uint32_t toX = log[m + 1] % width;
+                    uint32_t toY = log[m + 1] / width;
+                    deltas.recordMove(log[m], log[m + 1]);
+                    grid->markDirty(log[m] % width, log[m] / width);
+                    grid->markDirty(toX, toY);
+                    
+                    uint32_t word = toY * chunksX + toX / ChunkTracker::CHUNK_SIZE;
+                    if (movedMask[word] == 0) {
+                        movedWords.push_back(word);
+                    }
+                    movedMask[word] |= 1ULL << (toX % ChunkTracker::CHUNK_SIZE);
+                }
+                log.clear();
+            }
+            for (auto& log : threadUnsettledLogs) {
+                for (const auto& [word, unsettled] : log) {
+                    keepUnsettledAwake(chunks, word % chunksX, word / chunksX, unsettled);
+                }
+                log.clear();
+            }
+        }
+    }
+    
+    for (uint32_t word : movedWords) {
+        movedMask[word] = 0;
+    }
+    movedWords.clear();
+}
+
+void SimulationEngine::updateActiveList(const CounterRng& rng) {
+    uint32_t width = grid->getWidth();
+    
+    // Edits made since the last step disturb their neighbourhoods
+    for (uint32_t index : grid->getDirtyIndices()) {
+        activeCells->wake(index % width, index / width);
+    }
+    lastStepStats.active_cells = activeCells->step();
+    
+    auto move = [this](uint32_t fromX, uint32_t fromY, uint32_t toX, uint32_t toY) {
+        bool moved = connector->moveParticle(fromX, fromY, toX, toY);
+        if (moved) {
+            activeCells->wake(fromX, fromY);
+            activeCells->wake(toX, toY);
+            activeCells->markArrived(toX, toY);
+            lastStepStats.moves++;
+        }
+        return moved;
+    };
+    
+    for (uint32_t index : activeCells->getActive()) {
+        uint32_t x = index % width;
+        uint32_t y = index / width;
+        if (activeCells->hasArrived(index) || !grid->isOccupied(x, y)) continue;
+        
+        lastStepStats.cells_visited++;
+        uint64_t movesBefore = lastStepStats.moves;
+        stepParticle(*grid, x, y, rng, move);
+        
+        // Particles that stayed put but could still move are kept active;
+        // everything else settles until a neighbour changes
+        if (lastStepStats.moves == movesBefore && kernels::hasFreeTarget(*grid, x, y)) {
+            activeCells->wakeCell(x, y);
+        }
+    }
+}
+
+void SimulationEngine::setUpdateMode(UpdateMode mode) {
+    if (mode == UpdateMode::ACTIVE_LIST && updateMode != UpdateMode::ACTIVE_LIST) {
+        if (!activeCells) {
+            activeCells = std::make_unique<ActiveCellList>(grid->getOccupancy());
+        }
+        activeCells->clear();
+        
+        // Start from every particle with a free neighbour, 64 cells at a time
+        const OccupancyBitboard& occupancy = grid->getOccupancy();
+        for (uint32_t y = 0; y < grid->getHeight(); y++) {
+            for (uint32_t wx = 0; wx < occupancy.getWordsPerRow(); wx++) {
+                uint64_t bits = kernels::mobileMask(occupancy, wx, y);
+                while (bits) {
+                    uint32_t x = wx * OccupancyBitboard::WORD_BITS + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    activeCells->wakeCell(x, y);
+                }
+            }
+        }
+    }
+    updateMode = mode;
+}
+
+void SimulationEngine::addParticle(uint32_t x, uint32_t y, ParticleType type) {
+    if (!connector->isValidPosition(x, y) || !connector->isEmpty(x, y)) {
+        return;
+    }
+    
+    Particle p(type, getMaterial(type).mass);
+    
+    connector->addParticle(x, y, p);
+}
+
+void SimulationEngine::addParticlesInRadius(int centerX, int centerY, int radius, ParticleType type) {
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            // Calculate distance from center
+            float distance = std::sqrt(dx*dx + dy*dy);
+            
+            // Only add particles within the radius
+            int x = centerX + dx;
+            int y = centerY + dy;
+            if (distance <= radius && x >= 0 && y >= 0) {
+                addParticle(x, y, type);
+            }
+        }
+    }
+}
+
+void SimulationEngine::eraseParticlesInRadius(int centerX, int centerY, int radius) {
+    for (int dy = -radius; dy <= radius; dy++) {
+        for (int dx = -radius; dx <= radius; dx++) {
+            int x = centerX + dx;
+            int y = centerY + dy;
+            if (dx*dx + dy*dy <= radius*radius && x >= 0 && y >= 0 &&
+                connector->isValidPosition(x, y) && !connector->isEmpty(x, y)) {
+                connector->removeParticle(x, y);
+            }
+        }
+    }
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "../spatial/grid_spatial_connector.hpp"
+#include "../spatial/CellIndex.hpp"
+#include "../core/utils/CounterRng.hpp"
+#include "../grid/ActiveCellList.hpp"
+#include <memory>
+#include <vector>
+#include <utility>
+
+/**
+ * @brief Render-free simulation core
+ *
+ * Owns the Grid, SpatialHash and GridSpatialConnector and advances the
+ * particle physics one fixed step at a time. Has no SDL dependency, so it
+ * backs both the interactive SandSimulation and the headless runner.
+ *
+ * Usage Examples:
+ * @code
+ * SimulationEngine engine(400, 300);
+ * engine.addParticlesInRadius(200, 20, 5, ParticleType::SAND);
+ * engine.setUpdateMode(SimulationEngine::UpdateMode::ACTIVE_LIST);
+ *
+ * for (int i = 0; i < 1000; i++) {
+ *     engine.step();
+ * }
+ * auto stats = engine.getLastStepStats();
+ * @endcode
+ *
+ * API Categories:
+ *
+ * 1. Simulation:
+ *    - step(): Advance one tick
+ *    - setUpdateMode(): Chunk scan, checkerboard parallel or active list
+ *    - setParallelUpdate(): Toggle checkerboard parallel chunk updates
+ *    - setSpatialSync(): Toggle the per-step SpatialHash sync; the sync
+ *      applies the step's moves as deltas, and while it is off the hash
+ *      is not maintained
+ *    - setCellIndex(): Rebuild a dense CellIndex at the end of every step
+ *    - setSeed(): Seed the per-cell random draws; a seed and an initial
+ *      grid replay bit-exactly in both update modes
+ *
+ * 2. Editing:
+ *    - addParticle(): Place one particle with its default mass
+ *    - addParticlesInRadius(): Brush painting
+ *    - eraseParticlesInRadius(): Eraser brush; each particle leaves the
+ *      spatial hash in O(1) at the next sync
+ *    - clear(): Remove every particle
+ *
+ * 3. Access:
+ *    - getGrid(), getConnector(), getSpatialHash(): Underlying systems
+ *    - getCellIndex(): Per-cell particle index, null unless enabled
+ *    - getFrame(), getLastStepStats(): Step counters
+ *    - getLastDirtyRects(): Chunk rectangles changed by the last step,
+ *      including edits made before it (partial redraw, snapshots)
+ *
+ * Update Modes:
+ * - CHUNKED: Serial bottom-to-top scan of awake chunk rectangles
+ * - CHECKERBOARD: Chunk rows bottom to top, alternate awake chunks of a
+ *   row across OpenMP threads; a particle moved in one phase is not
+ *   stepped again by a later one
+ * - ACTIVE_LIST: Serial pass over the cells that moved or were disturbed
+ *   last tick; cost follows moving particles, not awake area. Edits made
+ *   between steps (brush, scene load) are picked up from the dirty cells.
+ *
+ * @see Grid, GridSpatialConnector, ChunkTracker, ActiveCellList
+ */
+class SimulationEngine {
+public:
+    static constexpr uint64_t DEFAULT_SEED = 0x5eed;
+
+    enum class UpdateMode {
+        CHUNKED,
+        CHECKERBOARD,
+        ACTIVE_LIST
+    };
+
+    /** @brief Work done by the most recent step() */
+    struct StepStats {
+        uint64_t cells_visited{0};
+        uint64_t moves{0};
+        uint32_t awake_chunks{0};
+        uint64_t active_cells{0};
+    };
+
+private:
+    std::unique_ptr<Grid> grid;
+    std::unique_ptr<SpatialHash> spatialHash;
+    std::unique_ptr<GridSpatialConnector> connector;
+
+    UpdateMode updateMode = UpdateMode::CHUNKED;
+    bool spatialSync = true;
+    
+    // CHECKERBOARD: chunk scheduling across OpenMP threads
+    std::vector<std::pair<uint32_t, uint32_t>> phaseChunks;
+    std::vector<std::vector<uint32_t>> threadMoveLogs;
+    // Per thread: (movedMask word, cells) of particles that stayed put but
+    // could still move, applied to the chunk tracker after each phase
+    std::vector<std::vector<std::pair<uint32_t, uint64_t>>> threadUnsettledLogs;
+    // Bit per cell, one word per chunk row span: particles moved this tick,
+    // so a later phase does not step them again
+    std::vector<uint64_t> movedMask;
+    std::vector<uint32_t> movedWords;
+    
+    // ACTIVE_LIST: allocated when the mode is first selected
+    std::unique_ptr<ActiveCellList> activeCells;
+    
+    // Lock-free per-cell index, rebuilt after each step when enabled
+    std::unique_ptr<CellIndex> cellIndex;
+
+    uint64_t seed = DEFAULT_SEED;
+    uint64_t frame = 0;
+    StepStats lastStepStats;
+    std::vector<ChunkRect> lastDirtyRects;
+
+public:
+    /**
+     * @param allocation Grid buffer policy, e.g. GridAllocation::numaAware()
+     *        to place pages near the threads of the parallel update
+     */
+    SimulationEngine(uint32_t width, uint32_t height, const GridAllocation& allocation = {})
+        : grid(std::make_unique<Grid>(width, height, 0, allocation))
+        , spatialHash(std::make_unique<SpatialHash>(*grid))
+        , connector(std::make_unique<GridSpatialConnector>(*grid, *spatialHash))
+    {}
+
+    void step();
+
+    void addParticle(uint32_t x, uint32_t y, ParticleType type);
+    void addParticlesInRadius(int centerX, int centerY, int radius, ParticleType type);
+    void eraseParticlesInRadius(int centerX, int centerY, int radius);
+    void clear() { connector->clear(); }
+
+    void setUpdateMode(UpdateMode mode);
+    UpdateMode getUpdateMode() const { return updateMode; }
+    void setParallelUpdate(bool enabled) {
+        setUpdateMode(enabled ? UpdateMode::CHECKERBOARD : UpdateMode::CHUNKED);
+    }
+    bool isParallelUpdate() const { return updateMode == UpdateMode::CHECKERBOARD; }
+    void setSpatialSync(bool enabled) { spatialSync = enabled; }
+    void setSeed(uint64_t value) { seed = value; }
+    void setCellIndex(bool enabled) {
+        if (!enabled) {
+            cellIndex.reset();
+        } else if (!cellIndex) {
+            cellIndex = std::make_unique<CellIndex>(*grid);
+            cellIndex->rebuild(*grid);
+        }
+    }
+    uint64_t getSeed() const { return seed; }
+
+    Grid& getGrid() { return *grid; }
+    const Grid& getGrid() const { return *grid; }
+    GridSpatialConnector& getConnector() { return *connector; }
+    SpatialHash& getSpatialHash() { return *spatialHash; }
+    const CellIndex* getCellIndex() const { return cellIndex.get(); }
+
+    uint64_t getFrame() const { return frame; }
+    const StepStats& getLastStepStats() const { return lastStepStats; }
+    const std::vector<ChunkRect>& getLastDirtyRects() const { return lastDirtyRects; }
+
+private:
+    void updateChunksSerial(const CounterRng& rng);
+    void updateChunksParallel(const CounterRng& rng);
+    void updateActiveList(const CounterRng& rng);
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @brief Stateless counter-based random numbers
+ *
+ * Every value is a pure hash of (seed, frame, x, y, stream), so there is no
+ * shared generator state to lock or advance. Any thread can draw the
+ * number for any cell, in any order, and a run replays bit-exactly from
+ * its seed.
+ *
+ * Usage Examples:
+ * @code
+ * CounterRng rng(seed, frame);
+ * bool goLeft = rng.coin(x, y);
+ * uint32_t pick = rng.next(x, y, 1) % 3;  // Second independent draw
+ * @endcode
+ *
+ * Implementation Details:
+ * - SplitMix64 finalizer applied to each counter component in turn
+ * - Streams give independent draws for the same cell and frame
+ */
+class CounterRng {
+private:
+    uint64_t key;
+
+    static constexpr uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+public:
+    constexpr CounterRng(uint64_t seed, uint64_t frame)
+        : key(mix(mix(seed + 0x9e3779b97f4a7c15ULL) ^ frame))
+    {}
+
+    /** @brief 64 random bits for the cell (x, y) */
+    constexpr uint64_t next(uint32_t x, uint32_t y, uint32_t stream = 0) const {
+        uint64_t cell = (static_cast<uint64_t>(y) << 32) | x;
+        return mix(mix(key ^ cell) + stream);
+    }
+
+    /** @brief Fair coin flip for the cell (x, y) */
+    constexpr bool coin(uint32_t x, uint32_t y, uint32_t stream = 0) const {
+        return next(x, y, stream) >> 63;
+    }
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include "OccupancyBitboard.hpp"
+/**
+ * @brief Compact, deduplicated list of cells to simulate next tick
+ *
+ * Holds the indices of particles that moved, or whose neighbourhood
+ * changed, during the previous tick. The simulation iterates only these
+ * cells, so per-frame cost follows the number of moving particles instead
+ * of the grid area or the number of awake chunks. Particles that settle
+ * are simply not queued again; a change next to them queues them back.
+ * Only occupied cells are queued: an empty cell that gets filled later in
+ * the tick is queued by the move that fills it.
+ *
+ * Usage Examples:
+ * @code
+ * ActiveCellList active(grid.getOccupancy());
+ *
+ * // Record a change: the cell and its occupied neighbours run next tick
+ * active.wake(x, y);
+ *
+ * // Start of tick: queued cells become the active list
+ * active.step();
+ * for (uint32_t index : active.getActive()) {
+ *     if (active.hasArrived(index)) continue;  // Already moved this tick
+ *     // Simulate index % width, index / width
+ * }
+ * @endcode
+ *
+ * API Categories:
+ *
+ * 1. Queueing:
+ *    - wake(): Queue the occupied cells of a 3x3 neighbourhood
+ *    - wakeCell(): Queue a single cell (a particle that can still move)
+ *    - step(): Promote the queue to the active list, bottom row first
+ *    - clear(): Drop every queued and active cell
+ *
+ * 2. Per-tick State:
+ *    - markArrived(): Record that a particle moved into a cell
+ *    - hasArrived(): Skip particles already moved this tick
+ *
+ * Memory Layout:
+ * - Two 1-bit-per-cell flag planes (queued, arrived)
+ * - Active and queued index lists, 4 bytes per entry
+ *
+ * Performance Characteristics:
+ * - wake(): O(1), at most 9 occupancy and flag tests
+ * - step(): O(a log a) for a active cells; flags are cleared through the
+ *   lists, never by scanning the grid
+ *
+ * Thread Safety:
+ * - Not thread-safe
+ *
+ * @see ChunkTracker, OccupancyBitboard, SimulationEngine
+ */
+class ActiveCellList {
+private:
+    const OccupancyBitboard& occupancy;
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint64_t> queued;   ///< Bit per cell: already in next
+    std::vector<uint64_t> arrived;  ///< Bit per cell: moved into this tick
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> next;
+    std::vector<uint32_t> arrivals;
+
+    static bool testBit(const std::vector<uint64_t>& bits, uint32_t index) {
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    static void setBit(std::vector<uint64_t>& bits, uint32_t index) {
+        bits[index >> 6] |= 1ULL << (index & 63);
+    }
+
+    static void clearBit(std::vector<uint64_t>& bits, uint32_t index) {
+        bits[index >> 6] &= ~(1ULL << (index & 63));
+    }
+
+    void queue(uint32_t index) {
+        if (!testBit(queued, index)) {
+            setBit(queued, index);
+            next.push_back(index);
+        }
+    }
+
+public:
+    explicit ActiveCellList(const OccupancyBitboard& occ)
+        : occupancy(occ)
+        , width(occ.getWidth())
+        , height(occ.getHeight())
+        , queued((static_cast<size_t>(width) * height + 63) / 64)
+        , arrived((static_cast<size_t>(width) * height + 63) / 64)
+    {}
+
+    /** @brief Queues the occupied cells in the 3x3 neighbourhood of a change */
+    void wake(uint32_t x, uint32_t y) {
+        uint32_t x0 = x > 0 ? x - 1 : 0;
+        uint32_t y0 = y > 0 ? y - 1 : 0;
+        uint32_t x1 = std::min(x + 1, width - 1);
+        uint32_t y1 = std::min(y + 1, height - 1);
+        for (uint32_t ny = y0; ny <= y1; ++ny) {
+            for (uint32_t nx = x0; nx <= x1; ++nx) {
+                if (occupancy.test(nx, ny)) {
+                    queue(ny * width + nx);
+                }
+            }
+        }
+    }
+
+    void wakeCell(uint32_t x, uint32_t y) {
+        queue(y * width + x);
+    }
+
+    /**
+     * @brief Starts a tick
+     * @return Number of active cells
+     * @note Cells are ordered by descending index (bottom row first) to
+     *       match the bottom-to-top sweep of the chunked update
+     */
+    size_t step() {
+        for (uint32_t index : arrivals) {
+            clearBit(arrived, index);
+        }
+        arrivals.clear();
+
+        active.swap(next);
+        next.clear();
+        for (uint32_t index : active) {
+            clearBit(queued, index);
+        }
+        std::sort(active.begin(), active.end(), std::greater<uint32_t>());
+        return active.size();
+    }
+
+    void markArrived(uint32_t x, uint32_t y) {
+        uint32_t index = y * width + x;
+        setBit(arrived, index);
+        arrivals.push_back(index);
+    }
+
+    bool hasArrived(uint32_t index) const {
+        return testBit(arrived, index);
+    }
+
+    void clear() {
+        std::fill(queued.begin(), queued.end(), 0);
+        std::fill(arrived.begin(), arrived.end(), 0);
+        active.clear();
+        next.clear();
+        arrivals.clear();
+    }
+
+    const std::vector<uint32_t>& getActive() const { return active; }
+    size_t getQueuedCount() const { return next.size(); }
+
+    size_t getMemoryUsage() const {
+        return (queued.size() + arrived.size()) * sizeof(uint64_t) +
+               (active.capacity() + next.capacity() + arrivals.capacity()) * sizeof(uint32_t);
+    }
+};
@@ -0,0 +1,242 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+/**
+ * @brief Fixed-size chunk partitioning with per-chunk active rectangles
+ *
+ * Splits the grid into CHUNK_SIZE x CHUNK_SIZE chunks. Each chunk keeps the
+ * bounding rectangle of the cells that changed during the previous tick
+ * (grown by one cell so that particles resting next to a change get a chance
+ * to react). Chunks whose rectangle is empty are asleep and are skipped by
+ * the simulation step, so per-frame cost follows activity instead of area.
+ *
+ * Independently of the tick, each chunk also keeps an exact dirty rectangle
+ * (no one-cell growth) of the cells marked since the last clearDirty(), plus
+ * a list of the chunks that have one. Downstream stages (spatial sync,
+ * renderer, snapshots) walk those few rectangles instead of every cell.
+ *
+ * Usage Examples:
+ * @code
+ * ChunkTracker chunks(width, height);
+ *
+ * // Record a change (wakes neighbouring chunks when x,y is on an edge)
+ * chunks.markActive(x, y);
+ *
+ * // Start of tick: promote pending changes to the active set
+ * chunks.step();
+ *
+ * // Scan only awake chunks
+ * for (uint32_t cy = 0; cy < chunks.getChunksY(); ++cy) {
+ *     for (uint32_t cx = 0; cx < chunks.getChunksX(); ++cx) {
+ *         const ChunkRect& r = chunks.getActiveRect(cx, cy);
+ *         if (r.isEmpty()) continue;
+ *         // Process r.min_x..r.max_x, r.min_y..r.max_y
+ *     }
+ * }
+ * @endcode
+ *
+ * API Categories:
+ *
+ * 1. State Management:
+ *    - markActive(): Record a change at a cell
+ *    - step(): Swap pending changes into the active set
+ *    - wakeAll(): Force every chunk awake for the next tick
+ *
+ * 2. Queries:
+ *    - isAwake(): Check chunk state
+ *    - getActiveRect(): Rectangle to scan this tick
+ *    - getAwakeCount(): Number of awake chunks
+ *
+ * 3. Dirty Regions:
+ *    - markDirty(): Grow the chunk's exact dirty rectangle
+ *    - forEachDirtyRect(): Visit the non-empty dirty rectangles
+ *    - getDirtyChunks(): Indices of chunks with a dirty rectangle
+ *    - clearDirty(): Reset the dirty rectangles
+ *
+ * Memory Layout:
+ * - Three rectangles (16 bytes each) per chunk
+ * - Chunks stored row-major
+ * - One index per dirty chunk
+ *
+ * Performance Characteristics:
+ * - markActive(): O(1), touches at most 4 chunks
+ * - markDirty(): O(1), touches one chunk
+ * - step(): O(chunks)
+ * - forEachDirtyRect(), clearDirty(): O(dirty chunks)
+ *
+ * Thread Safety:
+ * - Not thread-safe, callers serialize markActive()
+ *
+ * @see Grid, DirtyStateTracker
+ */
+struct ChunkRect {
+    uint32_t min_x = UINT32_MAX;
+    uint32_t min_y = UINT32_MAX;
+    uint32_t max_x = 0;
+    uint32_t max_y = 0;
+
+    bool isEmpty() const {
+        return min_x > max_x;
+    }
+
+    bool containsRow(uint32_t y) const {
+        return y >= min_y && y <= max_y;
+    }
+
+    void expand(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+        min_x = std::min(min_x, x0);
+        min_y = std::min(min_y, y0);
+        max_x = std::max(max_x, x1);
+        max_y = std::max(max_y, y1);
+    }
+
+    void reset() {
+        *this = ChunkRect();
+    }
+};
+
+class ChunkTracker {
+public:
+    /** @brief Chunk edge length in cells */
+    static const uint32_t CHUNK_SIZE = 64;
+
+private:
+    struct Chunk {
+        ChunkRect active;   ///< Cells to scan during the current tick
+        ChunkRect pending;  ///< Cells changed during the current tick
+        ChunkRect dirty;    ///< Cells marked since the last clearDirty()
+    };
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t chunks_x;
+    uint32_t chunks_y;
+    uint32_t awake_count;
+    std::vector<Chunk> chunks;
+    std::vector<uint32_t> dirty_chunks;
+
+public:
+    ChunkTracker(uint32_t w, uint32_t h)
+        : width(w)
+        , height(h)
+        , chunks_x((w + CHUNK_SIZE - 1) / CHUNK_SIZE)
+        , chunks_y((h + CHUNK_SIZE - 1) / CHUNK_SIZE)
+        , awake_count(0)
+        , chunks(chunks_x * chunks_y)
+    {}
+
+    /**
+     * @brief Records a change at a cell
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @note The 3x3 neighbourhood is added to the pending rectangles of
+     *       every chunk it overlaps, waking neighbours across chunk edges
+     */
+    void markActive(uint32_t x, uint32_t y) {
+        uint32_t x0 = x > 0 ? x - 1 : 0;
+        uint32_t y0 = y > 0 ? y - 1 : 0;
+        uint32_t x1 = std::min(x + 1, width - 1);
+        uint32_t y1 = std::min(y + 1, height - 1);
+
+        for (uint32_t cy = y0 / CHUNK_SIZE; cy <= y1 / CHUNK_SIZE; ++cy) {
+            uint32_t band_y0 = cy * CHUNK_SIZE;
+            uint32_t band_y1 = band_y0 + CHUNK_SIZE - 1;
+            for (uint32_t cx = x0 / CHUNK_SIZE; cx <= x1 / CHUNK_SIZE; ++cx) {
+                uint32_t band_x0 = cx * CHUNK_SIZE;
+                uint32_t band_x1 = band_x0 + CHUNK_SIZE - 1;
+                chunks[cy * chunks_x + cx].pending.expand(
+                    std::max(x0, band_x0), std::max(y0, band_y0),
+                    std::min(x1, band_x1), std::min(y1, band_y1)
+                );
+            }
+        }
+    }
+
+    /**
+     * @brief Starts a new tick
+     * @return Number of chunks awake for this tick
+     * @note Chunks with no changes during the last tick fall asleep
+     */
+    uint32_t step() {
+        awake_count = 0;
+        for (auto& chunk : chunks) {
+            chunk.active = chunk.pending;
+            chunk.pending.reset();
+            if (!chunk.active.isEmpty()) {
+                awake_count++;
+            }
+        }
+        return awake_count;
+    }
+
+    /** @brief Marks every cell pending so the next step() wakes all chunks */
+    void wakeAll() {
+        for (uint32_t cy = 0; cy < chunks_y; ++cy) {
+            for (uint32_t cx = 0; cx < chunks_x; ++cx) {
+                chunks[cy * chunks_x + cx].pending.expand(
+                    cx * CHUNK_SIZE, cy * CHUNK_SIZE,
+                    std::min((cx + 1) * CHUNK_SIZE, width) - 1,
+                    std::min((cy + 1) * CHUNK_SIZE, height) - 1
+                );
+            }
+        }
+    }
+
+    /**
+     * @brief Adds a cell to its chunk's dirty rectangle
+     * @note Exact bounds, unlike markActive(); the chunk is listed in
+     *       getDirtyChunks() on its first mark
+     */
+    void markDirty(uint32_t x, uint32_t y) {
+        uint32_t index = (y / CHUNK_SIZE) * chunks_x + x / CHUNK_SIZE;
+        ChunkRect& rect = chunks[index].dirty;
+        if (rect.isEmpty()) {
+            dirty_chunks.push_back(index);
+        }
+        rect.expand(x, y, x, y);
+    }
+
+    /**
+     * @brief Visits every non-empty dirty rectangle
+     * @param fn Callable (const ChunkRect&), in first-marked order
+     */
+    template<typename Fn>
+    void forEachDirtyRect(Fn&& fn) const {
+        for (uint32_t index : dirty_chunks) {
+            fn(chunks[index].dirty);
+        }
+    }
+
+    /** @brief Resets the dirty rectangles, touching only dirty chunks */
+    void clearDirty() {
+        for (uint32_t index : dirty_chunks) {
+            chunks[index].dirty.reset();
+        }
+        dirty_chunks.clear();
+    }
+
+    const ChunkRect& getDirtyRect(uint32_t cx, uint32_t cy) const {
+        return chunks[cy * chunks_x + cx].dirty;
+    }
+
+    /** @brief Dirty rectangle of a chunk index from getDirtyChunks() */
+    const ChunkRect& getDirtyRectAt(uint32_t index) const {
+        return chunks[index].dirty;
+    }
+
+    const std::vector<uint32_t>& getDirtyChunks() const { return dirty_chunks; }
+
+    bool isAwake(uint32_t cx, uint32_t cy) const {
+        return !chunks[cy * chunks_x + cx].active.isEmpty();
+    }
+
+    const ChunkRect& getActiveRect(uint32_t cx, uint32_t cy) const {
+        return chunks[cy * chunks_x + cx].active;
+    }
+
+    uint32_t getChunksX() const { return chunks_x; }
+    uint32_t getChunksY() const { return chunks_y; }
+    uint32_t getChunkCount() const { return chunks_x * chunks_y; }
+    uint32_t getAwakeCount() const { return awake_count; }
+};
@@ -1,138 +1,296 @@
 #pragma once
-#include <vector>
-#include <unordered_set>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
+#include <memory>
 /**
- * @brief High-performance dirty state tracking system with dual-storage optimization
- * 
- * Implements an efficient dual-tracking mechanism using bit vectors and hash sets
- * for optimal state tracking and iteration performance. Designed for large-scale
- * particle simulation systems.
- * 
+ * @brief High-performance dirty state tracking with a two-level atomic bitset
+ *
+ * Stores one dirty bit per cell in 64-bit words (rows padded to whole words)
+ * plus a summary level with one bit per non-zero word. Marking is a single
+ * atomic fetch_or, iteration skips clean regions 4096 cells at a time via
+ * the summary and walks set bits with count-trailing-zeros, so dirty cells
+ * always come out in ascending row-major order.
+ *
  * Performance Metrics (tested with 1M cells):
- * - Mark dirty: ~25M ops/second
- * - Clear dirty: ~30M ops/second
- * - Dirty check: ~45M checks/second
- * - Iteration: ~12M cells/second
- * 
+ * - Mark dirty: one fetch_or (plus one on the summary for a word's first bit)
+ * - Iteration: O(summary words + dirty words + dirty cells)
+ * - Clear all: O(summary words + dirty words)
+ *
  * Key Features:
  * - Bit-packed state storage
  * - O(1) state marking/checking
- * - Fast dirty cell iteration
- * - Memory-efficient design
- * - Thread-safe operations
- * 
+ * - Row-major ordered iteration without sorting
+ * - Clearing touches only words that were marked
+ * - Safe for concurrent markDirty() from parallel writers
+ *
  * Usage Examples:
  * @code
  * // Initialize tracker
  * DirtyStateTracker tracker(width, height);
- * 
+ *
  * // Mark cell as dirty
  * tracker.markDirty(x, y);
- * 
+ *
  * // Check cell state
  * bool isDirty = tracker.isDirty(x, y);
- * 
- * // Iterate dirty cells
+ *
+ * // Iterate dirty cells in row-major order
  * for(auto idx : tracker.getDirtyIndices()) {
  *     uint32_t x = idx % width;
  *     uint32_t y = idx / width;
  *     // Process dirty cell
  * }
- * 
+ *
  * // Clear all dirty states
  * tracker.clearAllDirty();
  * @endcode
- * 
+ *
  * API Categories:
- * 
+ *
  * 1. State Management:
  *    - markDirty(): Mark cell as dirty
  *    - clearDirty(): Clear cell state
  *    - isDirty(): Check cell state
- * 
+ *
  * 2. Bulk Operations:
  *    - clearAllDirty(): Reset all states
- *    - getDirtyIndices(): Get all dirty cells
- * 
+ *    - getDirtyIndices(): Range over dirty cells (size(), empty(), begin/end)
+ *    - forEachDirtyInRow(): Dirty cells of one row span, word at a time
+ *
  * Memory Layout:
- * - Bit vector: width * height / 8 bytes
- * - Index set: O(d) where d is dirty count
- * - Total: O(n/8 + d) bytes
- * 
+ * - Cell bits: ceil(width / 64) words per row
+ * - Summary bits: 1 bit per cell word (1/64 of the cell bits)
+ * - Total: ~n/8 bytes, independent of the dirty count
+ *
  * Performance Characteristics:
  * - Mark/Clear: O(1)
  * - State check: O(1)
- * - Iteration: O(d) where d is dirty count
- * - Memory access: Cache-friendly patterns
- * 
+ * - Iteration: O(d + n/4096) where d is dirty count
+ *
  * Implementation Details:
- * - Uses std::vector<bool> for bit packing
- * - Maintains parallel index set
- * - Optimized for cache coherency
- * - SIMD-friendly operations
- * 
+ * - Summary bit i is set when word i gets its first dirty bit
+ * - Summary bits are only reset by clearAllDirty(), so after clearDirty()
+ *   they may point at empty words; iteration skips those
+ * - Dirty count kept in an atomic counter for O(1) size()
+ *
  * Thread Safety:
- * - Atomic state updates
- * - Safe concurrent reads
- * - Protected index set access
- * 
- * Optimization Features:
- * - Bit-level parallelism
- * - Minimal memory footprint
- * - Efficient iteration support
- * - Cache-conscious design
- * 
+ * - markDirty()/clearDirty()/isDirty() are atomic (relaxed)
+ * - Iteration and clearAllDirty() must not overlap with writers
+ *
  * @note Best performance with contiguous access patterns
  * @see Grid, GridOperations
- */class DirtyStateTracker {
+ */
+class DirtyStateTracker {
+public:
+    static const uint32_t WORD_BITS = 64;
+
 private:
+    using Word = std::atomic<uint64_t>;
+
     uint32_t width;
     uint32_t height;
-    std::vector<bool> dirty_cells;
-    std::unordered_set<uint32_t> dirty_indices;
+    uint32_t words_per_row;
+    size_t word_count;
+    size_t summary_count;
+    std::unique_ptr<Word[]> words;
+    std::unique_ptr<Word[]> summary;
+    std::atomic<size_t> dirty_count;
+
+    size_t wordIndex(uint32_t x, uint32_t y) const {
+        return static_cast<size_t>(y) * words_per_row + x / WORD_BITS;
+    }
 
 public:
+    /**
+     * @brief Forward iterator over dirty cell indices (y * width + x)
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint32_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint32_t*;
+        using reference = uint32_t;
+
+    private:
+        const DirtyStateTracker* tracker;
+        size_t summary_index;
+        uint64_t summary_bits;
+        uint64_t bits;
+        uint32_t word_base;  ///< Cell index of bit 0 of the current word
+        uint32_t current;
+        bool done;
+
+        void advance() {
+            while (bits == 0) {
+                while (summary_bits == 0) {
+                    if (++summary_index >= tracker->summary_count) {
+                        done = true;
+                        return;
+                    }
+                    summary_bits = tracker->summary[summary_index].load(std::memory_order_relaxed);
+                }
+                size_t word_index = summary_index * WORD_BITS + __builtin_ctzll(summary_bits);
+                summary_bits &= summary_bits - 1;
+                bits = tracker->words[word_index].load(std::memory_order_relaxed);
+                uint32_t y = static_cast<uint32_t>(word_index / tracker->words_per_row);
+                uint32_t wx = static_cast<uint32_t>(word_index % tracker->words_per_row);
+                word_base = y * tracker->width + wx * WORD_BITS;
+            }
+            current = word_base + __builtin_ctzll(bits);
+            bits &= bits - 1;
+        }
+
+    public:
+        const_iterator(const DirtyStateTracker* t, bool begin)
+            : tracker(t)
+            , summary_index(0)
+            , summary_bits(0)
+            , bits(0)
+            , word_base(0)
+            , current(0)
+            , done(!begin || t->summary_count == 0)
+        {
+            if (!done) {
+                summary_bits = t->summary[0].load(std::memory_order_relaxed);
+                advance();
+            }
+        }
+
+        uint32_t operator*() const { return current; }
+
+        const_iterator& operator++() {
+            advance();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            advance();
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return done == other.done && (done || current == other.current);
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    /** @brief View returned by getDirtyIndices() */
+    class DirtyRange {
+    private:
+        const DirtyStateTracker* tracker;
+
+    public:
+        explicit DirtyRange(const DirtyStateTracker* t) : tracker(t) {}
+
+        const_iterator begin() const { return const_iterator(tracker, true); }
+        const_iterator end() const { return const_iterator(tracker, false); }
+        size_t size() const { return tracker->dirty_count.load(std::memory_order_relaxed); }
+        bool empty() const { return size() == 0; }
+    };
+
     DirtyStateTracker(uint32_t w, uint32_t h)
         : width(w)
         , height(h)
-        , dirty_cells(w * h, false)
-        , dirty_indices()
-    {}
+        , words_per_row((w + WORD_BITS - 1) / WORD_BITS)
+        , word_count(static_cast<size_t>(words_per_row) * h)
+        , summary_count((word_count + WORD_BITS - 1) / WORD_BITS)
+        , words(std::make_unique<Word[]>(word_count))
+        , summary(std::make_unique<Word[]>(summary_count))
+        , dirty_count(0)
+    {
+        for (size_t i = 0; i < word_count; ++i) {
+            words[i].store(0, std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < summary_count; ++i) {
+            summary[i].store(0, std::memory_order_relaxed);
+        }
+    }
 
     /**
      * @brief Marks a cell as dirty
      * @param x X coordinate
      * @param y Y coordinate
-     * @note Thread-safe for different coordinates
+     * @note Thread-safe, including for cells sharing a word
      */
     void markDirty(uint32_t x, uint32_t y) {
-        uint32_t index = y * width + x;
-        dirty_cells[index] = true;
-        dirty_indices.insert(index);
+        size_t w = wordIndex(x, y);
+        uint64_t bit = 1ULL << (x % WORD_BITS);
+        uint64_t previous = words[w].fetch_or(bit, std::memory_order_relaxed);
+        if (previous & bit) {
+            return;
+        }
+        dirty_count.fetch_add(1, std::memory_order_relaxed);
+        if (previous == 0) {
+            summary[w / WORD_BITS].fetch_or(1ULL << (w % WORD_BITS), std::memory_order_relaxed);
+        }
     }
 
     void clearDirty(uint32_t x, uint32_t y) {
-        uint32_t index = y * width + x;
-        dirty_cells[index] = false;
-        dirty_indices.erase(index);
+        uint64_t bit = 1ULL << (x % WORD_BITS);
+        uint64_t previous = words[wordIndex(x, y)].fetch_and(~bit, std::memory_order_relaxed);
+        if (previous & bit) {
+            dirty_count.fetch_sub(1, std::memory_order_relaxed);
+        }
     }
 
     bool isDirty(uint32_t x, uint32_t y) const {
-        return dirty_cells[y * width + x];
+        return (words[wordIndex(x, y)].load(std::memory_order_relaxed) >> (x % WORD_BITS)) & 1;
     }
 
     /**
-     * @brief Returns set of dirty cell indices
-     * @return Constant reference to dirty indices
-     * @note Indices are in row-major order
+     * @brief Returns the dirty cell indices
+     * @return Range with size()/empty(); iterates in ascending row-major order
      */
-    const std::unordered_set<uint32_t>& getDirtyIndices() const {
-        return dirty_indices;
+    DirtyRange getDirtyIndices() const {
+        return DirtyRange(this);
     }
 
+    /**
+     * @brief Visits the dirty cells x0..x1 of row y in x order
+     * @param fn Callable (x)
+     * @note Lets region consumers (ChunkTracker dirty rectangles) filter a
+     *       span with masked word reads instead of per-cell isDirty()
+     */
+    template<typename Fn>
+    void forEachDirtyInRow(uint32_t y, uint32_t x0, uint32_t x1, Fn&& fn) const {
+        size_t row = static_cast<size_t>(y) * words_per_row;
+        for (uint32_t wx = x0 / WORD_BITS; wx <= x1 / WORD_BITS; ++wx) {
+            uint64_t bits = words[row + wx].load(std::memory_order_relaxed);
+            uint32_t base = wx * WORD_BITS;
+            if (x0 > base) {
+                bits &= ~0ULL << (x0 - base);
+            }
+            if (x1 < base + WORD_BITS - 1) {
+                bits &= ~0ULL >> (WORD_BITS - 1 - (x1 - base));
+            }
+            while (bits) {
+                fn(base + __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    /** @brief Clears every dirty bit, visiting only words that were marked */
     void clearAllDirty() {
-        std::fill(dirty_cells.begin(), dirty_cells.end(), false);
-        dirty_indices.clear();
+        for (size_t s = 0; s < summary_count; ++s) {
+            uint64_t touched = summary[s].exchange(0, std::memory_order_relaxed);
+            while (touched) {
+                size_t w = s * WORD_BITS + __builtin_ctzll(touched);
+                touched &= touched - 1;
+                words[w].store(0, std::memory_order_relaxed);
+            }
+        }
+        dirty_count.store(0, std::memory_order_relaxed);
+    }
+
+    size_t getMemoryUsage() const {
+        return (word_count + summary_count) * sizeof(uint64_t);
     }
 };
@@ -1,12 +1,20 @@
 #pragma once
 
 #include "DirtyStateTracker.hpp"
+#include "ChunkTracker.hpp"
+#include "OccupancyBitboard.hpp"
+#include "Neighborhood.hpp"
+#include "GridFwd.hpp"
+#include "GridStorage.hpp"
 #include "../memory/MemoryMonitor.hpp"
 #include "../particle/Particle.hpp"
+#include "../particle/Material.hpp"
 #include <vector>
 #include <memory>
 #include <functional>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 #include "../core/utils/TimeUtils.hpp"
 /**
  * @brief Core grid system for particle simulation with optimized memory layout
@@ -24,6 +32,8 @@
  * Key Features:
  * - Row-major memory layout
  * - Integrated dirty state tracking
+ * - Chunk sleeping (64x64 chunks with active rectangles)
+ * - 1-bit occupancy plane kept in sync with every write
  * - SIMD-friendly data structure
  * - Boundary-aware operations
  * - Range-based iteration support
@@ -50,11 +60,27 @@
  *     // Update changed cells
  * }
  * 
+ * // Stencil rule: reads see only the previous step
+ * grid.enableDoubleBuffer();
+ * grid.stepStencil([&](uint32_t x, uint32_t y) {
+ *     return nextState(grid.atUnchecked(x, y), grid.isOccupied(x, y - 1));
+ * });
+ * 
+ * // Whole rows at a time, split across threads
+ * grid.parallelForEachRowSpan([&](uint32_t x0, uint32_t y, auto row) {
+ *     for (const Particle& p : row) { ... }
+ * });
+ * 
  * // Get valid neighbors
  * auto neighbors = grid.getValidNeighbors(x, y);
  * 
  * // Swap cells
  * grid.swap(x1, y1, x2, y2);
+ *
+ * // Structure-of-arrays layout with the same interface
+ * SoAGrid soa(1000, 1000);
+ * soa.at(x, y).setVelocity(0, 1);
+ * PlaneSpan<ParticleType> types = soa.getStorage().types();
  * @endcode
  * 
  * API Categories:
@@ -66,38 +92,93 @@
  * 
  * 2. Cell Operations:
  *    - swap(): Swap cell contents
- *    - getValidNeighbors(): Get valid adjacent cells
+ *    - swapUntracked(): Swap without dirty/chunk tracking (parallel kernels)
+ *    - getValidNeighbors(): Valid adjacent cells as an inline NeighborRange
+ *    - forEachNeighbor(), neighborMask(): Allocation-free neighbour walks
  *    - isValidPosition(): Check position validity
  * 
  * 3. Iteration:
  *    - begin()/end(): Full grid iteration
  *    - beginDirty()/endDirty(): Dirty cells only
- *    - forEachCell(): Cell callback iteration
+ *    - forEachCell(): Cell callback iteration (templated, inlined)
  *    - forEachDirtyCell(): Dirty cell callback
+ *    - forEachRowSpan(): Rows as contiguous Particle ranges
+ *    - parallelForEachCell(), parallelForEachRowSpan(): Rows split
+ *      across OpenMP threads
+ *    - parallelForEachDirtyCell(): Dirty chunks split across threads
  * 
  * 4. Grid Properties:
  *    - getWidth(): Grid width
  *    - getHeight(): Grid height
  *    - getDirtyIndices(): Get dirty cell indices
+ *    - forEachDirtyRect(), getDirtyRects(): Per-chunk dirty bounding boxes
+ *    - forEachDirtyInRect(): Dirty cells inside one rectangle
  * 
  * 5. State Management:
  *    - markDirty(): Mark cell as modified
  *    - clearDirtyStates(): Reset dirty tracking
+ *
+ * 6. Chunk Activity:
+ *    - stepChunks(): Start a tick, put idle chunks to sleep
+ *    - getChunks(): Access awake chunks and their active rectangles
+ *
+ * 7. Occupancy:
+ *    - isOccupied(): Single-bit emptiness test
+ *    - getOccupancy(): Packed 64-cells-per-word plane for mask kernels
+ *
+ * 8. Storage:
+ *    - getStorage(): Storage policy, whole planes for SoA kernels
+ *    - getAllocation(): Huge-page / first-touch policy of the buffers
+ *    - forEachInRow(), readRow(): Linear row spans for any layout
+ *
+ * 9. Double Buffering:
+ *    - enableDoubleBuffer(): Allocate a back buffer for stencil rules
+ *    - writeBack(): Write the next state while reads see the front
+ *    - flip(): Publish the back buffer with dirty/occupancy tracking
+ *    - stepStencil(): Parallel whole-grid rule followed by flip()
+ *
+ * Storage Policies (see GridStorage.hpp):
+ * - Grid = BasicGrid<AoSStorage>: 4-byte Particle structs; at() returns Particle&
+ * - SoAGrid = BasicGrid<SoAStorage>: one 64-byte aligned plane per field;
+ *   at() returns an SoAParticleRef proxy with the same members
+ * - MortonGrid = BasicGrid<MortonStorage>: Particle structs in Z-order
+ *   64x64 tiles for neighbourhood locality on wide grids
+ *
+ * Allocation (optional, constructor argument):
+ * - BasicGrid(w, h, halo, GridAllocation::numaAware()) backs the cells
+ *   with 2 MB huge pages and zeroes them from all OpenMP threads in
+ *   chunk-row bands, so pages sit near the threads that update them
+ * - Default: 64-byte aligned, zeroed on the constructing thread
+ *
+ * Halo (optional, constructor argument):
+ * - BasicGrid(w, h, halo) allocates halo WALL cells on every side; public
+ *   coordinates, at() and the iterators still cover only 0..w-1 x 0..h-1
+ * - atUnchecked() reads up to halo cells outside, so neighbour reads like
+ *   atUnchecked(x - 1, y + 1) need no bounds branch
+ * - The occupancy plane always has a guard ring, so isOccupied() of any
+ *   direct neighbour is safe even without a storage halo
  * 
  * Memory Layout:
- * - Particles: Contiguous row-major array
- * - Dirty states: Bit array (1 bit per cell)
+ * - Particles: Contiguous row-major array (or planes), per storage policy
+ * - Dirty states: Two-level bitset (1 bit per cell + 1 bit per 64 cells)
+ * - Chunk rectangles: 48 bytes per 64x64 chunk (active, pending, dirty)
+ * - Occupancy plane: 1 bit per cell, rows padded to 64 bits, plus a
+ *   one-word/one-row (or halo-row) guard ring of set bits
+ * - Halo: (w + 2 * halo) * (h + 2 * halo) cells of storage
+ * - Double buffering: a second storage plus 1 change bit per cell
  * - Memory overhead: sizeof(DirtyStateTracker)
  * 
  * Performance Characteristics:
  * - Cell access: O(1)
- * - Neighbor query: O(1)
- * - Dirty iteration: O(d) where d is dirty count
+ * - Neighbor query: O(1), no allocation
+ * - Dirty iteration: O(d + n/4096), ascending row-major order
  * - Memory usage: O(width * height)
  * 
  * Thread Safety:
  * - Read operations are thread-safe
  * - Cell updates require external synchronization
+ * - Writes that change emptiness must go through update()/swap() so the
+ *   occupancy plane stays in sync
  * - Dirty state tracking is atomic
  * 
  * Implementation Details:
@@ -107,19 +188,74 @@
  * - Efficient dirty state bit packing
  * 
  * @note Best performance with power-of-two dimensions
- * @see Particle, DirtyStateTracker, MemoryTracker
- */class Grid {
+ * @see Particle, GridStorage, DirtyStateTracker, MemoryTracker
+ */template<typename Storage>
+class BasicGrid {
+public:
+    using storage_type = Storage;
+    using reference = typename Storage::reference;
+    using const_reference = typename Storage::const_reference;
+
 private:
     uint32_t width;
     uint32_t height;
-    std::unique_ptr<Particle[]> particles;
+    uint32_t halo;
+    GridAllocation allocation;
+    Storage storage;
     DirtyStateTracker dirty_tracker;
-    std::unique_ptr<MemoryTracker<Grid>> memory_tracker;
+    ChunkTracker chunk_tracker;
+    OccupancyBitboard occupancy;
+    std::unique_ptr<MemoryTracker<BasicGrid>> memory_tracker;
+
+    // Double buffering, allocated by enableDoubleBuffer()
+    std::unique_ptr<Storage> back_storage;
+    std::unique_ptr<DirtyStateTracker> back_changes;  ///< Back cells differing from the front
+    std::unique_ptr<MemoryTracker<BasicGrid>> back_tracker;
 
     size_t calculateMemoryUsage(uint32_t w, uint32_t h) {
-        return (w * h * sizeof(Particle)) + // Particle array
-               (w * h / 8) +                // Dirty state bits
-               sizeof(DirtyStateTracker);   // Tracker overhead
+        return Storage::memoryUsage(w, h, halo) +  // Particle storage
+               ((w + 63) / 64) * h * 8 * 65 / 64 +  // Dirty bits + summary
+               sizeof(DirtyStateTracker) +  // Tracker overhead
+               ((w + ChunkTracker::CHUNK_SIZE - 1) / ChunkTracker::CHUNK_SIZE) *
+               ((h + ChunkTracker::CHUNK_SIZE - 1) / ChunkTracker::CHUNK_SIZE) *
+               3 * sizeof(ChunkRect) +      // Chunk rectangles
+               occupancy.getMemoryUsage();  // Occupancy plane and guard ring
+    }
+
+    // Border cells are walls: never empty, never written after construction
+    void fillHalo() {
+        const Particle wall(ParticleType::WALL, getMaterial(ParticleType::WALL).mass);
+        int64_t lo = -static_cast<int64_t>(halo);
+        for (int64_t y = lo; y < static_cast<int64_t>(height + halo); ++y) {
+            bool border_row = y < 0 || y >= static_cast<int64_t>(height);
+            for (int64_t x = lo; x < static_cast<int64_t>(width + halo); ++x) {
+                if (border_row || x < 0 || x >= static_cast<int64_t>(width)) {
+                    storage.store(storage.index(static_cast<uint32_t>(x), static_cast<uint32_t>(y)), wall);
+                }
+            }
+        }
+    }
+
+    // Every cell including the halo; both storages share one layout
+    void copyCells(Storage& dst, const Storage& src) const {
+        int64_t lo = -static_cast<int64_t>(halo);
+        for (int64_t y = lo; y < static_cast<int64_t>(height + halo); ++y) {
+            for (int64_t x = lo; x < static_cast<int64_t>(width + halo); ++x) {
+                size_t i = dst.index(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+                dst.store(i, src.load(i));
+            }
+        }
+    }
+
+    static bool sameParticle(const Particle& a, const Particle& b) {
+        return a.type == b.type && a.mass == b.mass &&
+               a.velocity_x == b.velocity_x && a.velocity_y == b.velocity_y;
+    }
+
+    void requireDoubleBuffer() const {
+        if (!back_storage) {
+            throw std::logic_error("Grid is not double-buffered, call enableDoubleBuffer() first");
+        }
     }
 
     void validatePosition(uint32_t x, uint32_t y) const {
@@ -131,18 +267,55 @@ private:
         }
     }
 
+    ChunkRect bounds() const {
+        ChunkRect all;
+        if (width > 0 && height > 0) {
+            all.expand(0, 0, width - 1, height - 1);
+        }
+        return all;
+    }
+
+    // One row of forEachRowSpan(): in place when rows are Particle arrays,
+    // otherwise copied into scratch
+    template<typename Fn>
+    void rowSpan(uint32_t y, uint32_t x0, uint32_t x1, std::vector<Particle>& scratch, Fn& fn) {
+        size_t count = x1 - x0 + 1;
+        if constexpr (Storage::CONTIGUOUS_ROWS) {
+            fn(x0, y, PlaneSpan<Particle>(storage.rowData(y) + x0, count));
+        } else {
+            scratch.resize(count);
+            readRow(y, x0, x1, scratch.data());
+            fn(x0, y, PlaneSpan<const Particle>(scratch.data(), count));
+        }
+    }
+
 public:
     bool isValidPosition(uint32_t x, uint32_t y) const {
         return x < width && y < height;
     }
     
-    Grid(uint32_t w, uint32_t h)
+    /**
+     * @param halo Wall cells kept on every side of the grid (0 = none).
+     *        Public coordinates stay 0..w-1 / 0..h-1; with a halo,
+     *        atUnchecked() and isOccupied() also accept up to halo cells
+     *        outside (x - 1 at x = 0 wraps onto the border) and read WALL
+     * @param allocation How the cell buffers are allocated and first
+     *        touched; GridAllocation::numaAware() for huge pages and
+     *        parallel first-touch
+     */
+    BasicGrid(uint32_t w, uint32_t h, uint32_t halo = 0, const GridAllocation& allocation = {})
         : width(w)
         , height(h)
-        , particles(std::make_unique<Particle[]>(w * h))
+        , halo(halo)
+        , allocation(allocation)
+        , storage(w, h, halo, allocation)
         , dirty_tracker(w, h)
-        , memory_tracker(std::make_unique<MemoryTracker<Grid>>("Grid", calculateMemoryUsage(w, h)))
-    {}
+        , chunk_tracker(w, h)
+        , occupancy(w, h, halo)
+        , memory_tracker(std::make_unique<MemoryTracker<BasicGrid>>("Grid", calculateMemoryUsage(w, h)))
+    {
+        fillHalo();
+    }
 
     /**
      * @brief Updates a cell with a new particle
@@ -152,48 +325,324 @@ public:
      * @throws std::out_of_range if position is invalid
      */
     void update(uint32_t x, uint32_t y, const Particle& p) {
-        particles[y * width + x] = p;
-        dirty_tracker.markDirty(x, y);
+        size_t idx = storage.index(x, y);
+        storage.store(idx, p);
+        if (back_storage) {
+            back_storage->store(idx, p);
+        }
+        occupancy.assign(x, y, !p.isEmpty());
+        markDirty(x, y);
     }
 
     void swap(uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2) {
-        uint32_t idx1 = y1 * width + x1;
-        uint32_t idx2 = y2 * width + x2;
-        std::swap(particles[idx1], particles[idx2]);
-        dirty_tracker.markDirty(x1, y1);
-        dirty_tracker.markDirty(x2, y2);
+        swapUntracked(x1, y1, x2, y2);
+        markDirty(x1, y1);
+        markDirty(x2, y2);
+    }
+
+    /**
+     * @brief Swaps two cells keeping only the occupancy plane in sync
+     * @note Safe from parallel kernels working on disjoint cells; the
+     *       caller must markDirty() both cells once threads have joined
+     */
+    void swapUntracked(uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2) {
+        size_t idx1 = storage.index(x1, y1);
+        size_t idx2 = storage.index(x2, y2);
+        storage.swap(idx1, idx2);
+        if (back_storage) {
+            back_storage->swap(idx1, idx2);
+        }
+        bool empty1 = storage.isEmpty(idx1);
+        bool empty2 = storage.isEmpty(idx2);
+        if (empty1 != empty2) {
+            occupancy.assign(x1, y1, !empty1);
+            occupancy.assign(x2, y2, !empty2);
+        }
     }
 
-    const std::unordered_set<uint32_t>& getDirtyIndices() const {
+    /**
+     * @brief Allocates a back buffer holding a copy of the grid
+     * @note While enabled, update(), swap() and swapUntracked() write both
+     *       buffers, so in-place edits survive the next flip()
+     */
+    void enableDoubleBuffer() {
+        if (back_storage) return;
+        back_storage = std::make_unique<Storage>(width, height, halo, allocation);
+        copyCells(*back_storage, storage);
+        back_changes = std::make_unique<DirtyStateTracker>(width, height);
+        back_tracker = std::make_unique<MemoryTracker<BasicGrid>>(
+            "Grid back buffer", Storage::memoryUsage(width, height, halo));
+    }
+
+    void disableDoubleBuffer() {
+        back_storage.reset();
+        back_changes.reset();
+        back_tracker.reset();
+    }
+
+    bool isDoubleBuffered() const { return back_storage != nullptr; }
+
+    /**
+     * @brief Writes a cell of the back buffer
+     * @note Requires enableDoubleBuffer(). Safe from parallel kernels
+     *       writing distinct cells: a change against the front buffer is
+     *       recorded with an atomic bit and published by flip()
+     */
+    void writeBack(uint32_t x, uint32_t y, const Particle& p) {
+        size_t idx = storage.index(x, y);
+        back_storage->store(idx, p);
+        if (!sameParticle(storage.load(idx), p)) {
+            back_changes->markDirty(x, y);
+        }
+    }
+
+    /**
+     * @brief Makes the back buffer the front
+     * @return Number of cells that changed
+     * @note The buffers swap in O(1). Only the changed cells are then
+     *       marked dirty, refreshed in the occupancy plane and copied into
+     *       the new back buffer, so both buffers agree for the next step
+     */
+    size_t flip() {
+        requireDoubleBuffer();
+        std::swap(storage, *back_storage);
+        
+        size_t changed = 0;
+        for (uint32_t index : back_changes->getDirtyIndices()) {
+            uint32_t x = index % width;
+            uint32_t y = index / width;
+            size_t idx = storage.index(x, y);
+            back_storage->store(idx, storage.load(idx));
+            occupancy.assign(x, y, !storage.isEmpty(idx));
+            markDirty(x, y);
+            changed++;
+        }
+        back_changes->clearAllDirty();
+        return changed;
+    }
+
+    /**
+     * @brief Applies a stencil rule to every cell, then flips
+     * @param fn Callable (x, y) -> Particle, the cell's next state. It reads
+     *        the front buffer only (at(), atUnchecked(), isOccupied()) and
+     *        never sees this step's writes, so rows run in parallel
+     * @return Number of cells that changed
+     */
+    template<typename Fn>
+    size_t stepStencil(Fn&& fn) {
+        requireDoubleBuffer();
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                writeBack(x, y, fn(x, y));
+            }
+        }
+        return flip();
+    }
+
+    /**
+     * @brief Single-bit emptiness test
+     * @note Never out of bounds for direct neighbours: the occupancy guard
+     *       ring makes cells one step outside the grid read as occupied,
+     *       with or without a storage halo
+     */
+    bool isOccupied(uint32_t x, uint32_t y) const {
+        return occupancy.test(x, y);
+    }
+
+    const OccupancyBitboard& getOccupancy() const { return occupancy; }
+
+    /**
+     * @brief Direct access to the storage policy
+     * @note Use for whole-plane kernels (SoAStorage::types() etc.). Writes
+     *       that change emptiness must still go through update()/swap().
+     */
+    Storage& getStorage() { return storage; }
+    const Storage& getStorage() const { return storage; }
+    const GridAllocation& getAllocation() const { return allocation; }
+
+    DirtyStateTracker::DirtyRange getDirtyIndices() const {
         return dirty_tracker.getDirtyIndices();
     }
 
+    /**
+     * @brief Visits the bounding rectangle of the dirty cells of each chunk
+     * @param fn Callable (const ChunkRect&); rectangles never span chunks
+     * @note A handful of rectangles per frame instead of every dirty index;
+     *       use forEachDirtyInRect() when only the marked cells matter
+     */
+    template<typename Fn>
+    void forEachDirtyRect(Fn&& fn) const {
+        chunk_tracker.forEachDirtyRect(std::forward<Fn>(fn));
+    }
+
+    /** @brief Copies the dirty rectangles into out (cleared first) */
+    void getDirtyRects(std::vector<ChunkRect>& out) const {
+        out.clear();
+        forEachDirtyRect([&](const ChunkRect& rect) { out.push_back(rect); });
+    }
+
+    size_t getDirtyRectCount() const {
+        return chunk_tracker.getDirtyChunks().size();
+    }
+
+    /**
+     * @brief Visits the dirty cells inside a rectangle in row-major order
+     * @param fn Callable (x, y, reference)
+     */
+    template<typename Fn>
+    void forEachDirtyInRect(const ChunkRect& rect, Fn&& fn) {
+        for (uint32_t y = rect.min_y; y <= rect.max_y; ++y) {
+            dirty_tracker.forEachDirtyInRow(y, rect.min_x, rect.max_x, [&](uint32_t x) {
+                fn(x, y, storage.ref(storage.index(x, y)));
+            });
+        }
+    }
+
     void clearDirtyStates() {
         dirty_tracker.clearAllDirty();
+        chunk_tracker.clearDirty();
     }
 
     void markDirty(uint32_t x, uint32_t y) {
         dirty_tracker.markDirty(x, y);
+        chunk_tracker.markActive(x, y);
+        chunk_tracker.markDirty(x, y);
     }
 
+    /**
+     * @brief Starts a simulation tick
+     * @return Number of awake chunks
+     * @note Chunks with no changes since the previous call go to sleep
+     */
+    uint32_t stepChunks() {
+        return chunk_tracker.step();
+    }
+
+    ChunkTracker& getChunks() { return chunk_tracker; }
+    const ChunkTracker& getChunks() const { return chunk_tracker; }
+
     uint32_t getWidth() const { return width; }
     uint32_t getHeight() const { return height; }
+    uint32_t getHalo() const { return halo; }
 
-    // Iterator for all cells
-    void forEachCell(std::function<void(uint32_t, uint32_t, Particle&)> callback) {
+    /**
+     * @brief Visits cells x0..x1 of row y in x order
+     * @param fn Callable (x, reference)
+     * @note Row-span helper for code that wants linear rows whatever the
+     *       layout; tiled storage steps its index incrementally
+     */
+    template<typename Fn>
+    void forEachInRow(uint32_t y, uint32_t x0, uint32_t x1, Fn&& fn) {
+        storage.forEachInRow(y, x0, x1, std::forward<Fn>(fn));
+    }
+
+    /** @brief Copies cells x0..x1 of row y into a linear buffer */
+    void readRow(uint32_t y, uint32_t x0, uint32_t x1, Particle* out) {
+        forEachInRow(y, x0, x1, [&](uint32_t x, reference p) {
+            out[x - x0] = p;
+        });
+    }
+
+    /**
+     * @brief Visits every cell in row-major order
+     * @param fn Callable (x, y, reference); inlined, no bounds checks
+     * @note Also accepts a std::function, as the previous signature did
+     */
+    template<typename Fn>
+    void forEachCell(Fn&& fn) {
         for (uint32_t y = 0; y < height; ++y) {
-            for (uint32_t x = 0; x < width; ++x) {
-                callback(x, y, at(x, y));
-            }
+            forEachInRow(y, 0, width - 1, [&](uint32_t x, reference p) {
+                fn(x, y, p);
+            });
         }
     }
 
-    // Iterator for dirty cells only
-    void forEachDirtyCell(std::function<void(uint32_t, uint32_t, Particle&)> callback) {
+    /** @brief Visits dirty cells in row-major order, fn(x, y, reference) */
+    template<typename Fn>
+    void forEachDirtyCell(Fn&& fn) {
         for (uint32_t index : dirty_tracker.getDirtyIndices()) {
             uint32_t x = index % width;
             uint32_t y = index / width;
-            callback(x, y, at(x, y));
+            fn(x, y, storage.ref(storage.index(x, y)));
+        }
+    }
+
+    /**
+     * @brief Visits the rows of a rectangle as contiguous Particle ranges
+     * @param fn Callable (x0, y, span) where span covers rect.min_x..max_x
+     * @note Row-major layouts hand out PlaneSpan<Particle> into the grid
+     *       itself; other layouts copy each row into a PlaneSpan<const
+     *       Particle> scratch buffer, so writes must go through the grid
+     */
+    template<typename Fn>
+    void forEachRowSpan(const ChunkRect& rect, Fn&& fn) {
+        if (rect.isEmpty()) return;
+        std::vector<Particle> scratch;
+        for (uint32_t y = rect.min_y; y <= rect.max_y; ++y) {
+            rowSpan(y, rect.min_x, rect.max_x, scratch, fn);
+        }
+    }
+
+    template<typename Fn>
+    void forEachRowSpan(Fn&& fn) {
+        forEachRowSpan(bounds(), std::forward<Fn>(fn));
+    }
+
+    /**
+     * @brief forEachCell() with rows split across OpenMP threads
+     * @note fn runs concurrently and must only touch its own cell
+     */
+    template<typename Fn>
+    void parallelForEachCell(Fn&& fn) {
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (uint32_t y = 0; y < height; ++y) {
+            forEachInRow(y, 0, width - 1, [&](uint32_t x, reference p) {
+                fn(x, y, p);
+            });
+        }
+    }
+
+    /** @brief forEachRowSpan() with rows split across OpenMP threads */
+    template<typename Fn>
+    void parallelForEachRowSpan(const ChunkRect& rect, Fn&& fn) {
+        if (rect.isEmpty()) return;
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+            std::vector<Particle> scratch;
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (uint32_t y = rect.min_y; y <= rect.max_y; ++y) {
+                rowSpan(y, rect.min_x, rect.max_x, scratch, fn);
+            }
+        }
+    }
+
+    template<typename Fn>
+    void parallelForEachRowSpan(Fn&& fn) {
+        parallelForEachRowSpan(bounds(), std::forward<Fn>(fn));
+    }
+
+    /**
+     * @brief forEachDirtyCell() with dirty chunks split across OpenMP threads
+     * @note Chunk dirty rectangles never overlap; the order is row-major
+     *       within each chunk only
+     */
+    template<typename Fn>
+    void parallelForEachDirtyCell(Fn&& fn) {
+        const std::vector<uint32_t>& dirty = chunk_tracker.getDirtyChunks();
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic)
+#endif
+        for (size_t i = 0; i < dirty.size(); ++i) {
+            forEachDirtyInRect(chunk_tracker.getDirtyRectAt(dirty[i]), fn);
         }
     }
 
@@ -201,21 +650,16 @@ public:
     template<bool DirtyOnly = false>
     class GridIterator {
     private:
-        Grid& grid;
+        BasicGrid& grid;
         uint32_t current_index;
-        const std::unordered_set<uint32_t>* dirty_indices;
-        typename std::unordered_set<uint32_t>::const_iterator dirty_it;
+        DirtyStateTracker::const_iterator dirty_it;
 
     public:
-        GridIterator(Grid& g, bool begin = true) 
+        GridIterator(BasicGrid& g, bool begin = true) 
             : grid(g)
             , current_index(begin ? 0 : g.width * g.height)
-        {
-            if constexpr (DirtyOnly) {
-                dirty_indices = &g.getDirtyIndices();
-                dirty_it = begin ? dirty_indices->begin() : dirty_indices->end();
-            }
-        }
+            , dirty_it(DirtyOnly && begin ? g.getDirtyIndices().begin() : g.getDirtyIndices().end())
+        {}
 
         bool operator!=(const GridIterator& other) const {
             if constexpr (DirtyOnly) {
@@ -236,17 +680,17 @@ public:
         auto operator*() {
             if constexpr (DirtyOnly) {
                 uint32_t idx = *dirty_it;
-                return std::make_tuple(
+                return std::tuple<uint32_t, uint32_t, reference>(
                     idx % grid.width,
                     idx / grid.width,
-                    std::ref(grid.at(idx % grid.width, idx / grid.width))
+                    grid.at(idx % grid.width, idx / grid.width)
                 );
             } else {
-                return std::make_tuple(
+                return std::tuple<uint32_t, uint32_t, reference>(
                     current_index % grid.width,
                     current_index / grid.width,
-                    std::ref(grid.at(current_index % grid.width, 
-                                   current_index / grid.width))
+                    grid.at(current_index % grid.width, 
+                            current_index / grid.width)
                 );
             }
         }
@@ -259,45 +703,43 @@ public:
     auto endDirty() { return GridIterator<true>(*this, false); }
 
     // Safe access methods with bounds checking
-    Particle& at(uint32_t x, uint32_t y) {
+    reference at(uint32_t x, uint32_t y) {
         validatePosition(x, y);
-        return particles[y * width + x];
+        return storage.ref(storage.index(x, y));
     }
 
-    const Particle& at(uint32_t x, uint32_t y) const {
+    const_reference at(uint32_t x, uint32_t y) const {
         validatePosition(x, y);
-        return particles[y * width + x];
+        return storage.ref(storage.index(x, y));
     }
 
     // Fast access methods for performance-critical code
-    Particle& atUnchecked(uint32_t x, uint32_t y) {
-        return particles[y * width + x];
+    reference atUnchecked(uint32_t x, uint32_t y) {
+        return storage.ref(storage.index(x, y));
     }
 
-    const Particle& atUnchecked(uint32_t x, uint32_t y) const {
-        return particles[y * width + x];
+    const_reference atUnchecked(uint32_t x, uint32_t y) const {
+        return storage.ref(storage.index(x, y));
     }
 
-    // Boundary-aware neighbor access
-    std::vector<std::pair<uint32_t, uint32_t>> getValidNeighbors(
-        uint32_t x, uint32_t y, bool diagonal = true
-    ) const {
-        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
-        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
-        
-        std::vector<std::pair<uint32_t, uint32_t>> neighbors;
-        neighbors.reserve(diagonal ? 8 : 4);
-
-        int check_count = diagonal ? 8 : 4;
-        for (int i = 0; i < check_count; ++i) {
-            int nx = static_cast<int>(x) + dx[i];
-            int ny = static_cast<int>(y) + dy[i];
-            
-            if (nx >= 0 && nx < static_cast<int>(width) && 
-                ny >= 0 && ny < static_cast<int>(height)) {
-                neighbors.emplace_back(nx, ny);
-            }
-        }
-        return neighbors;
+    // Boundary-aware neighbor access, no heap allocation
+    
+    /** @brief Validity mask over NEIGHBOR_OFFSETS for (x, y) */
+    uint8_t neighborMask(uint32_t x, uint32_t y, bool diagonal = true) const {
+        return ::neighborMask(x, y, width, height, diagonal);
+    }
+
+    /**
+     * @brief Calls fn(nx, ny) for each in-bounds neighbour of (x, y)
+     * @note Orthogonal neighbours first, then diagonals; inlines to a walk
+     *       over the set bits of neighborMask()
+     */
+    template<typename Fn>
+    void forEachNeighbor(uint32_t x, uint32_t y, Fn&& fn, bool diagonal = true) const {
+        forEachInMask(x, y, neighborMask(x, y, diagonal), std::forward<Fn>(fn));
+    }
+
+    NeighborRange getValidNeighbors(uint32_t x, uint32_t y, bool diagonal = true) const {
+        return NeighborRange(x, y, neighborMask(x, y, diagonal));
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,24 @@
+#pragma once
+/**
+ * @brief Forward declarations for the Grid template
+ *
+ * Lets headers that only hold Grid pointers (ParticleRef) name the type
+ * without pulling in the full grid and its trackers.
+ *
+ * @see BasicGrid, GridStorage
+ */
+struct AoSStorage;
+struct SoAStorage;
+struct MortonStorage;
+
+template<typename Storage>
+class BasicGrid;
+
+/** @brief Default grid: one Particle struct per cell */
+using Grid = BasicGrid<AoSStorage>;
+
+/** @brief Grid with one aligned plane per Particle field */
+using SoAGrid = BasicGrid<SoAStorage>;
+
+/** @brief Grid with Particle structs in Z-order 64x64 tiles */
+using MortonGrid = BasicGrid<MortonStorage>;
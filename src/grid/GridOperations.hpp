@@ -1,5 +1,6 @@
 #pragma once
 #include "Grid.hpp"
+#include "ParticleDeltaLog.hpp"
 #include <algorithm>
 #include <functional>
 /**
@@ -33,6 +34,10 @@
  *     // Handle particle movement
  * });
  * 
+ * // Record moves, spawns and despawns for incremental index updates
+ * ParticleDeltaLog log;
+ * ops.setDeltaLog(&log);
+ * 
  * // Move particle with boundary check
  * bool moved = ops.moveParticle(x1, y1, x2, y2);
  * 
@@ -48,20 +53,22 @@
  * 1. Movement Operations:
  *    - moveParticle(): Safe particle movement
  *    - setMoveCallback(): Movement notification
+ *    - setDeltaLog(): Log of occupancy changes (moves, spawns, despawns)
  * 
  * 2. Neighbor Access:
- *    - getNeighbors(): Get valid neighbors
- *    - getNeighborsFiltered(): Filtered neighbor query
+ *    - getNeighbors(): Get valid neighbors (inline NeighborRange)
+ *    - forEachNeighbor(): Callback over valid neighbors
  * 
  * 3. Cell Operations:
  *    - updateCell(): Safe cell update
  *    - isValidPosition(): Boundary check
  * 
  * Implementation Details:
- * - Pre-allocated neighbor vectors
- * - Cached direction patterns
+ * - Inline neighbor ranges (no per-query allocation)
+ * - Shared direction table (NEIGHBOR_OFFSETS)
  * - Boundary validation
  * - Move notification system
+ * - Every occupancy change is logged when a ParticleDeltaLog is attached
  * 
  * Performance Characteristics:
  * - Movement: O(1) with callback
@@ -69,8 +76,8 @@
  * - Cell update: O(1) with validation
  * 
  * Memory Usage:
- * - Neighbor cache: 8 * sizeof(pair<uint32_t>)
- * - Direction patterns: 8 * sizeof(int)
+ * - NeighborRange: 8 * sizeof(pair<uint32_t>) on the caller's stack
+ * - Direction patterns: 8 * sizeof(NeighborOffset), shared
  * - Callback storage: sizeof(function)
  * 
  * Thread Safety:
@@ -94,55 +101,57 @@ public:
      * @param to_x Target X coordinate
      * @param to_y Target Y coordinate
      * @return true if move successful
-     * @note Automatically handles dirty state
+     * @note Automatically handles dirty state, the delta log and the
+     *       move callback
      */
     bool moveParticle(uint32_t from_x, uint32_t from_y, uint32_t to_x, uint32_t to_y) {
-        if (!isValidPosition(to_x, to_y)) {
+        if (!isValidPosition(from_x, from_y) || !isValidPosition(to_x, to_y)) {
             return false;
         }
 
-        auto& source = grid.at(from_x, from_y);
-        auto& target = grid.at(to_x, to_y);
-
-        if (target.isEmpty()) {
-            std::swap(source, target);
-            grid.markDirty(from_x, from_y);
-            grid.markDirty(to_x, to_y);
+        if (!grid.isOccupied(to_x, to_y)) {
+            grid.swap(from_x, from_y, to_x, to_y);
+            // Swapping two empty cells changes no occupancy
+            if (deltaLog && grid.isOccupied(to_x, to_y)) {
+                deltaLog->recordMove(cellIndex(from_x, from_y), cellIndex(to_x, to_y));
+            }
+            notifyParticleMove(from_x, from_y, to_x, to_y);
             return true;
         }
         return false;
     }
 
+    /** @brief Writes p to (x, y); logs a spawn or despawn if occupancy changes */
     void updateCell(uint32_t x, uint32_t y, const Particle& p) {
         if (!isValidPosition(x, y)) {
             return;
         }
-        grid.at(x, y) = p;
-        grid.markDirty(x, y);
+        bool was_occupied = grid.isOccupied(x, y);
+        grid.update(x, y, p);
+        if (deltaLog && was_occupied != !p.isEmpty()) {
+            if (was_occupied) {
+                deltaLog->recordDespawn(cellIndex(x, y));
+            } else {
+                deltaLog->recordSpawn(cellIndex(x, y));
+            }
+        }
     }
 
     /**
      * @brief Gets valid neighboring cells
      * @param x Center X coordinate
      * @param y Center Y coordinate
-     * @return Vector of valid neighbor coordinates
-     * @note Pre-allocates vector capacity
+     * @return Inline range of up to 8 neighbor coordinates
+     * @note No heap allocation; see forEachNeighbor() for a callback form
      */
-    std::vector<std::pair<uint32_t, uint32_t>> getNeighbors(uint32_t x, uint32_t y) {
-        static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
-        static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
-        
-        std::vector<std::pair<uint32_t, uint32_t>> neighbors;
-        neighbors.reserve(8);
+    NeighborRange getNeighbors(uint32_t x, uint32_t y) const {
+        return grid.getValidNeighbors(x, y);
+    }
 
-        for (int i = 0; i < 8; ++i) {
-            uint32_t nx = x + dx[i];
-            uint32_t ny = y + dy[i];
-            if (isValidPosition(nx, ny)) {
-                neighbors.emplace_back(nx, ny);
-            }
-        }
-        return neighbors;
+    /** @brief Calls fn(nx, ny) for each valid neighbor of (x, y) */
+    template<typename Fn>
+    void forEachNeighbor(uint32_t x, uint32_t y, Fn&& fn) const {
+        grid.forEachNeighbor(x, y, std::forward<Fn>(fn));
     }
 
     void notifyParticleMove(uint32_t from_x, uint32_t from_y, uint32_t to_x, uint32_t to_y) {
@@ -156,11 +165,21 @@ public:
         moveCallback = cb;
     }
 
+    /** @brief Logs occupancy changes to log from now on; nullptr stops logging */
+    void setDeltaLog(ParticleDeltaLog* log) {
+        deltaLog = log;
+    }
+
 private:
     bool isValidPosition(uint32_t x, uint32_t y) const {
         return x < grid.getWidth() && y < grid.getHeight();
     }
+
+    uint32_t cellIndex(uint32_t x, uint32_t y) const {
+        return y * grid.getWidth() + x;
+    }
     
     MoveCallback moveCallback;
+    ParticleDeltaLog* deltaLog = nullptr;
 };
 
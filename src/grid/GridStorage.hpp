@@ -0,0 +1,373 @@
+#pragma once
+#include "../particle/Particle.hpp"
+#include "../memory/CellAllocator.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+/**
+ * @brief Cell storage policies for BasicGrid
+ *
+ * A storage policy owns the particle data of a grid and decides its memory
+ * layout. BasicGrid maps (x, y) through the policy's index() and never
+ * assumes rows are contiguous, so every policy sits behind the same
+ * at()/atUnchecked()/swap() interface and iterators.
+ *
+ * Policies:
+ * - AoSStorage: One 4-byte Particle struct per cell (the default Grid)
+ * - SoAStorage: Separate type, mass, velocity_x and velocity_y planes,
+ *   each 64-byte aligned, so a kernel reading only types streams 1 byte
+ *   per cell instead of 4
+ * - MortonStorage: Particle structs in 64x64 tiles, Z-order inside each
+ *   tile, so a 3x3 neighbourhood usually sits in one or two cache lines
+ *   instead of three rows that are width * 4 bytes apart
+ *
+ * Usage Examples:
+ * @code
+ * SoAGrid grid(1000, 1000);
+ * grid.at(10, 20) = Particle(ParticleType::SAND);
+ *
+ * // Whole planes for vectorised kernels
+ * PlaneSpan<ParticleType> types = grid.getStorage().types();
+ * size_t sand = std::count(types.begin(), types.end(), ParticleType::SAND);
+ * @endcode
+ *
+ * Policy Interface:
+ * - reference / const_reference: What at() returns (Particle& for AoS, a
+ *   field-reference proxy for SoA)
+ * - Constructor (w, h, halo, allocation): halo extra cells allocated on
+ *   every side; buffers come from allocateCells() with the given
+ *   GridAllocation, first-touched in 64-row bands
+ * - index(x, y): Storage position of a cell (row-major or tiled); valid
+ *   for x in [-halo, w + halo) and y in [-halo, h + halo), where negative
+ *   coordinates arrive as wrapped uint32_t (x - 1 at x = 0)
+ * - ref(i), load(i), store(i, p), swap(i, j), isEmpty(i)
+ * - forEachInRow(y, x0, x1, fn): Visit a row span in x order, stepping
+ *   the storage index incrementally
+ * - CONTIGUOUS_ROWS: Whether rows are Particle arrays; if so, rowData(y)
+ *   returns a pointer to cell x = 0 of row y
+ * - memoryUsage(w, h, halo): Bytes allocated for a grid of that size
+ *
+ * Halo:
+ * - Coordinates are shifted by halo before indexing, in uint32_t, so the
+ *   wrap-around of x - 1 lands on the border instead of out of bounds
+ * - BasicGrid fills the border with ParticleType::WALL; with halo 0 the
+ *   layouts are unchanged
+ *
+ * @see BasicGrid, Particle
+ */
+
+/** @brief Contiguous view of one storage plane */
+template<typename T>
+class PlaneSpan {
+private:
+    T* ptr;
+    size_t count;
+
+public:
+    PlaneSpan(T* data, size_t size) : ptr(data), count(size) {}
+
+    T* data() const { return ptr; }
+    size_t size() const { return count; }
+    T& operator[](size_t i) const { return ptr[i]; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + count; }
+};
+
+struct AoSStorage {
+    using reference = Particle&;
+    using const_reference = const Particle&;
+
+    static constexpr bool CONTIGUOUS_ROWS = true;
+
+    static constexpr uint32_t BAND_ROWS = 64;  ///< One chunk row
+
+    uint32_t stride;  ///< Row pitch, width + 2 * halo
+    uint32_t halo;
+    size_t cells;
+    CellArray<Particle> particles;
+
+    AoSStorage(uint32_t w, uint32_t h, uint32_t border = 0, const GridAllocation& allocation = {})
+        : stride(w + 2 * border)
+        , halo(border)
+        , cells(static_cast<size_t>(stride) * (h + 2 * border))
+        , particles(allocateCells<Particle>(cells, allocation,
+                                            static_cast<size_t>(stride) * BAND_ROWS * sizeof(Particle)))
+    {}
+
+    size_t index(uint32_t x, uint32_t y) const {
+        return static_cast<size_t>(y + halo) * stride + (x + halo);
+    }
+
+    reference ref(size_t i) { return particles[i]; }
+    const_reference ref(size_t i) const { return particles[i]; }
+    Particle load(size_t i) const { return particles[i]; }
+    void store(size_t i, const Particle& p) { particles[i] = p; }
+    void swap(size_t i, size_t j) { std::swap(particles[i], particles[j]); }
+    bool isEmpty(size_t i) const { return particles[i].isEmpty(); }
+
+    Particle* rowData(uint32_t y) { return particles.get() + index(0, y); }
+    const Particle* rowData(uint32_t y) const { return particles.get() + index(0, y); }
+
+    template<typename Fn>
+    void forEachInRow(uint32_t y, uint32_t x0, uint32_t x1, Fn&& fn) {
+        Particle* row = rowData(y);
+        for (uint32_t x = x0; x <= x1; ++x) {
+            fn(x, row[x]);
+        }
+    }
+
+    PlaneSpan<Particle> cellsSpan() { return {particles.get(), cells}; }
+    PlaneSpan<const Particle> cellsSpan() const { return {particles.get(), cells}; }
+
+    static size_t memoryUsage(uint32_t w, uint32_t h, uint32_t border = 0) {
+        return static_cast<size_t>(w + 2 * border) * (h + 2 * border) * sizeof(Particle);
+    }
+};
+
+/**
+ * @brief Writable view of one SoA cell
+ *
+ * Mirrors Particle's members as references into the planes, so code
+ * written against Particle& (p.type, p.setVelocity(), p = Particle(...))
+ * works unchanged on an SoA grid.
+ */
+struct SoAParticleRef {
+    ParticleType& type;
+    uint8_t& mass;
+    uint8_t& velocity_x;
+    uint8_t& velocity_y;
+
+    SoAParticleRef(ParticleType& t, uint8_t& m, uint8_t& vx, uint8_t& vy)
+        : type(t), mass(m), velocity_x(vx), velocity_y(vy) {}
+
+    // Copies rebind to the same cell; assignment below copies values
+    SoAParticleRef(const SoAParticleRef&) = default;
+
+    // Assignment writes through, like assigning to a Particle&
+    SoAParticleRef& operator=(const Particle& p) {
+        type = p.type;
+        mass = p.mass;
+        velocity_x = p.velocity_x;
+        velocity_y = p.velocity_y;
+        return *this;
+    }
+
+    SoAParticleRef& operator=(const SoAParticleRef& other) {
+        return *this = static_cast<Particle>(other);
+    }
+
+    operator Particle() const {
+        Particle p(type, mass);
+        p.velocity_x = velocity_x;
+        p.velocity_y = velocity_y;
+        return p;
+    }
+
+    bool isEmpty() const { return type == ParticleType::EMPTY; }
+    int8_t getVelocityX() const { return static_cast<int8_t>(velocity_x); }
+    int8_t getVelocityY() const { return static_cast<int8_t>(velocity_y); }
+
+    void setVelocity(int8_t vx, int8_t vy) {
+        velocity_x = static_cast<uint8_t>(vx);
+        velocity_y = static_cast<uint8_t>(vy);
+    }
+};
+
+struct SoAStorage {
+    using reference = SoAParticleRef;
+    using const_reference = Particle;
+
+    static constexpr bool CONTIGUOUS_ROWS = false;
+    static constexpr size_t ALIGNMENT = CACHE_LINE_SIZE;
+    static constexpr uint32_t BAND_ROWS = 64;  ///< One chunk row
+
+    using Plane = CellArray<uint8_t>;
+
+    uint32_t stride;  ///< Row pitch, width + 2 * halo
+    uint32_t halo;
+    size_t cells;
+    Plane type_plane;
+    Plane mass_plane;
+    Plane velocity_x_plane;
+    Plane velocity_y_plane;
+
+    static size_t planeBytes(size_t n) {
+        return (n + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // Zeroed, 0 == ParticleType::EMPTY
+    Plane allocatePlane(const GridAllocation& allocation) const {
+        return allocateCells<uint8_t>(planeBytes(cells), allocation,
+                                      static_cast<size_t>(stride) * BAND_ROWS);
+    }
+
+    SoAStorage(uint32_t w, uint32_t h, uint32_t border = 0, const GridAllocation& allocation = {})
+        : stride(w + 2 * border)
+        , halo(border)
+        , cells(static_cast<size_t>(stride) * (h + 2 * border))
+        , type_plane(allocatePlane(allocation))
+        , mass_plane(allocatePlane(allocation))
+        , velocity_x_plane(allocatePlane(allocation))
+        , velocity_y_plane(allocatePlane(allocation))
+    {}
+
+    size_t index(uint32_t x, uint32_t y) const {
+        return static_cast<size_t>(y + halo) * stride + (x + halo);
+    }
+
+    reference ref(size_t i) {
+        return SoAParticleRef(reinterpret_cast<ParticleType&>(type_plane[i]), mass_plane[i],
+                              velocity_x_plane[i], velocity_y_plane[i]);
+    }
+
+    const_reference ref(size_t i) const { return load(i); }
+
+    Particle load(size_t i) const {
+        Particle p(static_cast<ParticleType>(type_plane[i]), mass_plane[i]);
+        p.velocity_x = velocity_x_plane[i];
+        p.velocity_y = velocity_y_plane[i];
+        return p;
+    }
+
+    void store(size_t i, const Particle& p) { ref(i) = p; }
+
+    void swap(size_t i, size_t j) {
+        std::swap(type_plane[i], type_plane[j]);
+        std::swap(mass_plane[i], mass_plane[j]);
+        std::swap(velocity_x_plane[i], velocity_x_plane[j]);
+        std::swap(velocity_y_plane[i], velocity_y_plane[j]);
+    }
+
+    bool isEmpty(size_t i) const {
+        return type_plane[i] == static_cast<uint8_t>(ParticleType::EMPTY);
+    }
+
+    template<typename Fn>
+    void forEachInRow(uint32_t y, uint32_t x0, uint32_t x1, Fn&& fn) {
+        size_t base = index(0, y);
+        for (uint32_t x = x0; x <= x1; ++x) {
+            fn(x, ref(base + x));
+        }
+    }
+
+    // Whole planes, 64-byte aligned, one byte per cell; with a halo the
+    // planes include the border, so address them through index()
+    PlaneSpan<ParticleType> types() { return {reinterpret_cast<ParticleType*>(type_plane.get()), cells}; }
+    PlaneSpan<const ParticleType> types() const { return {reinterpret_cast<const ParticleType*>(type_plane.get()), cells}; }
+    PlaneSpan<uint8_t> masses() { return {mass_plane.get(), cells}; }
+    PlaneSpan<const uint8_t> masses() const { return {mass_plane.get(), cells}; }
+    PlaneSpan<uint8_t> velocitiesX() { return {velocity_x_plane.get(), cells}; }
+    PlaneSpan<const uint8_t> velocitiesX() const { return {velocity_x_plane.get(), cells}; }
+    PlaneSpan<uint8_t> velocitiesY() { return {velocity_y_plane.get(), cells}; }
+    PlaneSpan<const uint8_t> velocitiesY() const { return {velocity_y_plane.get(), cells}; }
+
+    static size_t memoryUsage(uint32_t w, uint32_t h, uint32_t border = 0) {
+        return 4 * planeBytes(static_cast<size_t>(w + 2 * border) * (h + 2 * border));
+    }
+};
+
+/** @brief Spreads the low 6 bits of v onto the even bits 0..10 */
+constexpr uint16_t mortonSpread(uint32_t v) {
+    v &= 0x3f;
+    v = (v | (v << 4)) & 0x30f;
+    v = (v | (v << 2)) & 0x333;
+    v = (v | (v << 1)) & 0x555;
+    return static_cast<uint16_t>(v);
+}
+
+constexpr std::array<uint16_t, 64> makeMortonSpreadTable() {
+    std::array<uint16_t, 64> table{};
+    for (uint32_t i = 0; i < table.size(); ++i) {
+        table[i] = mortonSpread(i);
+    }
+    return table;
+}
+
+inline constexpr std::array<uint16_t, 64> MORTON_SPREAD = makeMortonSpreadTable();
+
+/**
+ * @brief Particle structs in Z-order (Morton) 64x64 tiles
+ *
+ * Tiles are stored row-major and match the ChunkTracker chunks, so a 64x64
+ * tile is one contiguous 16 KB block. Inside a tile the cell offset
+ * interleaves the bits of (x & 63) and (y & 63): x on even bits, y on odd
+ * bits. The grid is padded to whole tiles. With a halo the tiles are laid
+ * over the shifted coordinates and no longer line up with chunks.
+ */
+struct MortonStorage {
+    using reference = Particle&;
+    using const_reference = const Particle&;
+
+    static constexpr bool CONTIGUOUS_ROWS = false;
+    static constexpr uint32_t TILE_BITS = 6;
+    static constexpr uint32_t TILE_SIZE = 1u << TILE_BITS;
+    static constexpr uint32_t TILE_CELLS = TILE_SIZE * TILE_SIZE;
+    static constexpr uint32_t X_BITS = 0x555;  ///< Offset bits holding x
+
+    uint32_t tiles_x;
+    uint32_t halo;
+    size_t cells;
+    CellArray<Particle> particles;
+
+    static uint32_t spread(uint32_t v) { return MORTON_SPREAD[v & (TILE_SIZE - 1)]; }
+
+    static uint32_t tilesFor(uint32_t n) { return (n + TILE_SIZE - 1) / TILE_SIZE; }
+
+    // First-touch bands are one row of tiles, i.e. one chunk row
+    MortonStorage(uint32_t w, uint32_t h, uint32_t border = 0, const GridAllocation& allocation = {})
+        : tiles_x(tilesFor(w + 2 * border))
+        , halo(border)
+        , cells(static_cast<size_t>(tiles_x) * tilesFor(h + 2 * border) * TILE_CELLS)
+        , particles(allocateCells<Particle>(cells, allocation,
+                                            static_cast<size_t>(tiles_x) * TILE_CELLS * sizeof(Particle)))
+    {}
+
+    size_t tileBase(uint32_t x, uint32_t y) const {
+        return (static_cast<size_t>(y >> TILE_BITS) * tiles_x + (x >> TILE_BITS)) * TILE_CELLS;
+    }
+
+    size_t index(uint32_t x, uint32_t y) const {
+        x += halo;
+        y += halo;
+        return tileBase(x, y) + (spread(x) | (spread(y) << 1));
+    }
+
+    reference ref(size_t i) { return particles[i]; }
+    const_reference ref(size_t i) const { return particles[i]; }
+    Particle load(size_t i) const { return particles[i]; }
+    void store(size_t i, const Particle& p) { particles[i] = p; }
+    void swap(size_t i, size_t j) { std::swap(particles[i], particles[j]); }
+    bool isEmpty(size_t i) const { return particles[i].isEmpty(); }
+
+    /**
+     * @brief Visits a row span in x order
+     * @note Steps the x bits of the Morton offset with a masked increment
+     *       instead of re-encoding every cell
+     */
+    template<typename Fn>
+    void forEachInRow(uint32_t y, uint32_t x0, uint32_t x1, Fn&& fn) {
+        y += halo;
+        x1 += halo;
+        uint32_t y_bits = spread(y) << 1;
+        uint32_t x = x0 + halo;
+        while (x <= x1) {
+            Particle* tile = particles.get() + tileBase(x, y);
+            uint32_t tile_end = std::min(x1, (x | (TILE_SIZE - 1)));
+            uint32_t x_bits = spread(x);
+            for (; x <= tile_end; ++x) {
+                fn(x - halo, tile[x_bits | y_bits]);
+                x_bits = ((x_bits | ~X_BITS) + 1) & X_BITS;
+            }
+        }
+    }
+
+    static size_t memoryUsage(uint32_t w, uint32_t h, uint32_t border = 0) {
+        return static_cast<size_t>(tilesFor(w + 2 * border)) * tilesFor(h + 2 * border) *
+               TILE_CELLS * sizeof(Particle);
+    }
+};
+
+static_assert(sizeof(ParticleType) == 1, "SoA type plane stores one byte per cell");
@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+/**
+ * @brief Allocation-free 8-neighbourhood helpers
+ *
+ * A cell's in-bounds neighbours are described by an 8-bit validity mask
+ * over a fixed offset table, so queries never touch the heap. Callers
+ * either walk the mask directly (forEachInMask(), what Grid::forEachNeighbor()
+ * inlines to) or take a NeighborRange, a fixed-capacity inline container
+ * that behaves like the vector of coordinate pairs it replaces.
+ *
+ * Usage Examples:
+ * @code
+ * // Inlined callback, no container at all
+ * grid.forEachNeighbor(x, y, [&](uint32_t nx, uint32_t ny) {
+ *     count += grid.isOccupied(nx, ny);
+ * });
+ *
+ * // Value range with size() / operator[] / range-for
+ * for (auto [nx, ny] : grid.getValidNeighbors(x, y)) {
+ *     // Process neighbour
+ * }
+ * @endcode
+ *
+ * Mask Layout (bit i = NEIGHBOR_OFFSETS[i]):
+ * - Bits 0-3: left, right, up, down (the orthogonal neighbours)
+ * - Bits 4-7: up-left, down-left, up-right, down-right
+ *
+ * Performance Characteristics:
+ * - neighborMask(): four compares, no branches
+ * - NeighborRange: 66 bytes on the stack, no allocation
+ *
+ * @see Grid, GridOperations
+ */
+
+struct NeighborOffset {
+    int8_t dx;
+    int8_t dy;
+};
+
+/** @brief Orthogonal neighbours first, then diagonals */
+inline constexpr std::array<NeighborOffset, 8> NEIGHBOR_OFFSETS = {{
+    {-1, 0}, {1, 0}, {0, -1}, {0, 1},
+    {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
+}};
+
+/** @brief Mask of the orthogonal bits */
+inline constexpr uint8_t ORTHOGONAL_NEIGHBORS = 0x0F;
+
+/**
+ * @brief Validity mask of the neighbours of (x, y) in a w x h grid
+ * @param diagonal Include bits 4-7
+ */
+inline uint8_t neighborMask(uint32_t x, uint32_t y, uint32_t w, uint32_t h, bool diagonal = true) {
+    uint32_t left = x > 0;
+    uint32_t right = x + 1 < w;
+    uint32_t up = y > 0;
+    uint32_t down = y + 1 < h;
+    uint32_t mask = left | (right << 1) | (up << 2) | (down << 3);
+    if (diagonal) {
+        mask |= ((left & up) << 4) | ((left & down) << 5) |
+                ((right & up) << 6) | ((right & down) << 7);
+    }
+    return static_cast<uint8_t>(mask);
+}
+
+/**
+ * @brief Calls fn(nx, ny) for every neighbour set in mask, in offset order
+ */
+template<typename Fn>
+inline void forEachInMask(uint32_t x, uint32_t y, uint8_t mask, Fn&& fn) {
+    uint32_t bits = mask;
+    while (bits) {
+        const NeighborOffset& offset = NEIGHBOR_OFFSETS[__builtin_ctz(bits)];
+        bits &= bits - 1;
+        fn(x + offset.dx, y + offset.dy);
+    }
+}
+
+/**
+ * @brief Up to eight neighbour coordinates stored inline
+ * @note Drop-in for the std::vector<std::pair<uint32_t, uint32_t>> the
+ *       neighbour queries used to return: size(), empty(), operator[]
+ *       and iteration over pairs
+ */
+class NeighborRange {
+public:
+    using value_type = std::pair<uint32_t, uint32_t>;
+    using const_iterator = const value_type*;
+
+private:
+    std::array<value_type, 8> cells;
+    uint8_t count;
+    uint8_t valid;
+
+public:
+    NeighborRange(uint32_t x, uint32_t y, uint8_t mask)
+        : count(0)
+        , valid(mask)
+    {
+        forEachInMask(x, y, mask, [&](uint32_t nx, uint32_t ny) {
+            cells[count++] = value_type(nx, ny);
+        });
+    }
+
+    const_iterator begin() const { return cells.data(); }
+    const_iterator end() const { return cells.data() + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const value_type& operator[](size_t i) const { return cells[i]; }
+
+    /** @brief Validity mask the range was built from */
+    uint8_t mask() const { return valid; }
+};
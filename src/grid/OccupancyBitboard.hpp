@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+/**
+ * @brief Packed 1-bit-per-cell occupancy plane
+ *
+ * Stores one bit per grid cell (1 = non-empty), 64 cells per word, rows
+ * padded to whole words. Lets kernels test emptiness or compute masks for
+ * 64 cells at once with plain word operations instead of loading
+ * Particle structs.
+ *
+ * Bit layout:
+ * - Word (wx, y) covers cells x = wx * 64 .. wx * 64 + 63 of row y
+ * - Bit b of that word is cell x = wx * 64 + b
+ * - Padding bits past the grid width are set, so edges read as walls
+ * - A guard ring of all-ones words surrounds the plane: one word column
+ *   on each side and guard_rows rows above and below. word(-1..wpr,
+ *   -guard_rows..height+guard_rows-1) and test() up to 64 cells left/right
+ *   of the grid read as walls with no range check
+ *
+ * Usage Examples:
+ * @code
+ * OccupancyBitboard occupancy(width, height);
+ * occupancy.assign(x, y, true);
+ *
+ * // Cells in word 0 of row y that have an empty cell below
+ * uint64_t canFall = occupancy.word(0, y) & ~occupancy.word(0, y + 1);
+ *
+ * // Neighbour tests need no bounds checks; x - 1 wraps into the guard
+ * bool blockedLeft = occupancy.test(x - 1, y + 1);
+ * @endcode
+ *
+ * Thread Safety:
+ * - Bit updates use atomic fetch_or/fetch_and, so threads may update
+ *   different bits of the same word concurrently
+ * - Reads are relaxed atomic loads
+ *
+ * @see Grid
+ */
+class OccupancyBitboard {
+public:
+    static const uint32_t WORD_BITS = 64;
+
+private:
+    uint32_t width;
+    uint32_t height;
+    uint32_t words_per_row;
+    uint32_t guard_rows;
+    uint32_t stride;         ///< words_per_row plus the two guard columns
+    std::unique_ptr<std::atomic<uint64_t>[]> words;
+
+    // Unsigned wrap-around maps x in [-64, 0) and y in [-guard_rows, 0)
+    // onto the guard words, so callers may pass x - 1 or y - 1 directly
+    std::atomic<uint64_t>& wordAt(uint32_t x, uint32_t y) const {
+        return words[static_cast<size_t>(y + guard_rows) * stride + (x + WORD_BITS) / WORD_BITS];
+    }
+
+public:
+    /**
+     * @param guard Wall rows above and below the grid (at least 1)
+     */
+    OccupancyBitboard(uint32_t w, uint32_t h, uint32_t guard = 1)
+        : width(w)
+        , height(h)
+        , words_per_row((w + WORD_BITS - 1) / WORD_BITS)
+        , guard_rows(std::max<uint32_t>(guard, 1))
+        , stride(words_per_row + 2)
+        , words(std::make_unique<std::atomic<uint64_t>[]>(
+              static_cast<size_t>(stride) * (h + 2 * guard_rows)))
+    {
+        clear();
+    }
+
+    /** @brief Marks every cell empty (padding and guard bits stay set) */
+    void clear() {
+        uint32_t tail_bits = width % WORD_BITS;
+        uint64_t padding = tail_bits ? ~0ULL << tail_bits : 0;
+        for (uint32_t row = 0; row < height + 2 * guard_rows; ++row) {
+            bool guard_row = row < guard_rows || row >= height + guard_rows;
+            for (uint32_t col = 0; col < stride; ++col) {
+                uint64_t value = 0;
+                if (guard_row || col == 0 || col == stride - 1) {
+                    value = ~0ULL;
+                } else if (col == words_per_row) {
+                    value = padding;
+                }
+                words[static_cast<size_t>(row) * stride + col].store(value, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void assign(uint32_t x, uint32_t y, bool occupied) {
+        uint64_t bit = 1ULL << (x % WORD_BITS);
+        if (occupied) {
+            wordAt(x, y).fetch_or(bit, std::memory_order_relaxed);
+        } else {
+            wordAt(x, y).fetch_and(~bit, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Tests one cell
+     * @note Cells in the guard ring (e.g. x - 1 at x = 0) read as occupied
+     */
+    bool test(uint32_t x, uint32_t y) const {
+        return (wordAt(x, y).load(std::memory_order_relaxed) >> (x % WORD_BITS)) & 1;
+    }
+
+    /**
+     * @brief Gets a 64-cell word
+     * @param wx Word column, -1 .. words_per_row
+     * @param y Row, -guard_rows .. height + guard_rows - 1
+     * @return Occupancy bits, all ones in the guard ring
+     */
+    uint64_t word(int64_t wx, int64_t y) const {
+        return words[static_cast<size_t>(y + guard_rows) * stride + static_cast<size_t>(wx + 1)]
+            .load(std::memory_order_relaxed);
+    }
+
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    uint32_t getWordsPerRow() const { return words_per_row; }
+    uint32_t getGuardRows() const { return guard_rows; }
+
+    size_t getMemoryUsage() const {
+        return static_cast<size_t>(stride) * (height + 2 * guard_rows) * sizeof(uint64_t);
+    }
+};
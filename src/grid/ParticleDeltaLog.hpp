@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Ordered log of particle moves, spawns and despawns
+ *
+ * GridOperations records every change of cell occupancy here, as cell
+ * indices (y * width + x), so indexes built on top of the grid (the
+ * SpatialHash) can follow the grid incrementally instead of rescanning
+ * dirty cells. Type changes of an occupied cell are not logged, since
+ * they do not move a particle between cells.
+ *
+ * coalesce() reduces the log to its net effect per cell: a particle that
+ * moved A -> B -> C becomes one removal at A and one insertion at C, and a
+ * spawn followed by a despawn cancels out. Every cell then appears at most
+ * once in the result, so the changes can be applied in any order and in
+ * parallel.
+ *
+ * Usage Examples:
+ * @code
+ * ParticleDeltaLog log;
+ * ops.setDeltaLog(&log);
+ * ops.moveParticle(x, y, x, y + 1);
+ *
+ * std::vector<uint32_t> removed, inserted;
+ * log.coalesce(removed, inserted);
+ * log.clear();
+ * @endcode
+ *
+ * Performance Characteristics:
+ * - record*(): O(1) amortized, 12 bytes per entry
+ * - coalesce(): O(k log k) for k entries, scratch space reused
+ *
+ * Thread Safety:
+ * - Not thread-safe; parallel writers keep their own logs and append them
+ *   in the order their changes happened
+ *
+ * @see GridOperations, GridSpatialConnector
+ */
+class ParticleDeltaLog {
+public:
+    struct Delta {
+        enum class Kind : uint8_t {
+            SPAWN,    ///< to became occupied
+            DESPAWN,  ///< from became empty
+            MOVE      ///< Particle moved from -> to, into an empty cell
+        };
+        Kind kind;
+        uint32_t from;
+        uint32_t to;
+    };
+
+private:
+    std::vector<Delta> deltas;
+    std::vector<uint64_t> events;  // Scratch for coalesce()
+
+    // Event key: cell, then position in the log, then the occupancy
+    // before (bit 1) and after (bit 0) the change
+    void addEvent(uint32_t cell, size_t order, bool before, bool after) {
+        events.push_back((static_cast<uint64_t>(cell) << 32) |
+                         (static_cast<uint64_t>(order) << 2) |
+                         (static_cast<uint64_t>(before) << 1) |
+                         static_cast<uint64_t>(after));
+    }
+
+public:
+    void recordMove(uint32_t from, uint32_t to) {
+        deltas.push_back({Delta::Kind::MOVE, from, to});
+    }
+
+    void recordSpawn(uint32_t cell) {
+        deltas.push_back({Delta::Kind::SPAWN, cell, cell});
+    }
+
+    void recordDespawn(uint32_t cell) {
+        deltas.push_back({Delta::Kind::DESPAWN, cell, cell});
+    }
+
+    /**
+     * @brief Net occupancy change of every cell the log touches
+     * @param removed Cells occupied before the log and empty after it
+     * @param inserted Cells empty before the log and occupied after it
+     */
+    void coalesce(std::vector<uint32_t>& removed, std::vector<uint32_t>& inserted) {
+        removed.clear();
+        inserted.clear();
+        events.clear();
+        events.reserve(deltas.size() * 2);
+
+        // Two events per move keep the order bits below 2^30 for up to
+        // 2^29 moves per log
+        for (size_t i = 0; i < deltas.size(); ++i) {
+            const Delta& d = deltas[i];
+            switch (d.kind) {
+                case Delta::Kind::SPAWN:   addEvent(d.to, i * 2, false, true); break;
+                case Delta::Kind::DESPAWN: addEvent(d.from, i * 2, true, false); break;
+                case Delta::Kind::MOVE:
+                    addEvent(d.from, i * 2, true, false);
+                    addEvent(d.to, i * 2 + 1, false, true);
+                    break;
+            }
+        }
+        std::sort(events.begin(), events.end());
+
+        // Per cell: occupancy before its first event, after its last one
+        for (size_t i = 0; i < events.size();) {
+            uint32_t cell = static_cast<uint32_t>(events[i] >> 32);
+            bool before = events[i] & 2;
+            size_t last = i;
+            while (last + 1 < events.size() && static_cast<uint32_t>(events[last + 1] >> 32) == cell) {
+                ++last;
+            }
+            bool after = events[last] & 1;
+            if (before && !after) removed.push_back(cell);
+            if (!before && after) inserted.push_back(cell);
+            i = last + 1;
+        }
+    }
+
+    void clear() { deltas.clear(); }
+    bool empty() const { return deltas.empty(); }
+    size_t size() const { return deltas.size(); }
+
+    const Delta& operator[](size_t i) const { return deltas[i]; }
+    std::vector<Delta>::const_iterator begin() const { return deltas.begin(); }
+    std::vector<Delta>::const_iterator end() const { return deltas.end(); }
+};
@@ -0,0 +1,186 @@
+#include "app/SimulationEngine.hpp"
+#include "app/Scene.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <omp.h>
+
+namespace {
+
+struct Options {
+    uint32_t width = 2000;
+    uint32_t height = 2000;
+    uint64_t steps = 1000;
+    std::string scenePath;
+    std::string generator = "rain";
+    float density = 0.5f;
+    uint32_t seed = 42;
+    bool parallel = false;
+    bool active = false;
+    bool sync = false;
+    bool numa = false;
+    bool cellIndex = false;
+    int threads = 0;
+    std::string snapshotPath;
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --width N        Grid width for generated scenes (default 2000)\n"
+              << "  --height N       Grid height for generated scenes (default 2000)\n"
+              << "  --steps N        Number of fixed steps to run (default 1000)\n"
+              << "  --scene FILE     Load a text scene instead of generating one\n"
+              << "  --generate NAME  Scene generator: rain, settled (default rain)\n"
+              << "  --density F      Fill density for generated scenes (default 0.5)\n"
+              << "  --seed N         Seed for scene generation and the simulation (default 42)\n"
+              << "  --parallel       Use the checkerboard parallel chunk update\n"
+              << "  --active         Use the sparse active-cell list update\n"
+              << "  --sync           Sync the SpatialHash every step (off by default)\n"
+              << "  --numa           Huge-page grid with parallel first-touch allocation\n"
+              << "  --cell-index     Rebuild the dense per-cell particle index every step\n"
+              << "  --threads N      OpenMP thread count for every mode: the parallel update,\n"
+              << "                   first-touch allocation, CellIndex rebuild and hash sync\n"
+              << "  --snapshot FILE  Write the final grid as a text scene, kept current\n"
+              << "                   from each step's dirty chunk rectangles\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        } else if (arg == "--parallel") {
+            options.parallel = true;
+        } else if (arg == "--active") {
+            options.active = true;
+        } else if (arg == "--sync") {
+            options.sync = true;
+        } else if (arg == "--numa") {
+            options.numa = true;
+        } else if (arg == "--cell-index") {
+            options.cellIndex = true;
+        } else if (!hasValue) {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        } else if (arg == "--width") {
+            options.width = std::stoul(argv[++i]);
+        } else if (arg == "--height") {
+            options.height = std::stoul(argv[++i]);
+        } else if (arg == "--steps") {
+            options.steps = std::stoull(argv[++i]);
+        } else if (arg == "--scene") {
+            options.scenePath = argv[++i];
+        } else if (arg == "--generate") {
+            options.generator = argv[++i];
+        } else if (arg == "--density") {
+            options.density = std::stof(argv[++i]);
+        } else if (arg == "--seed") {
+            options.seed = std::stoul(argv[++i]);
+        } else if (arg == "--threads") {
+            options.threads = std::stoi(argv[++i]);
+        } else if (arg == "--snapshot") {
+            options.snapshotPath = argv[++i];
+        } else {
+            std::cerr << "Unknown option " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.parallel && options.active) {
+        std::cerr << "--parallel and --active are exclusive\n";
+        return false;
+    }
+    return options.width > 0 && options.height > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        if (options.threads > 0) {
+            omp_set_num_threads(options.threads);
+        }
+
+        Scene scene = options.scenePath.empty()
+            ? Scene::generate(options.generator, options.width, options.height,
+                              options.seed, options.density)
+            : Scene::load(options.scenePath);
+
+        SimulationEngine engine(scene.getWidth(), scene.getHeight(),
+                                options.numa ? GridAllocation::numaAware() : GridAllocation::standard());
+        engine.setParallelUpdate(options.parallel);
+        engine.setSpatialSync(options.sync);
+        engine.setSeed(options.seed);
+        engine.setCellIndex(options.cellIndex);
+        scene.applyTo(engine);
+        if (options.active) {
+            engine.setUpdateMode(SimulationEngine::UpdateMode::ACTIVE_LIST);
+        }
+
+        uint64_t cellsVisited = 0;
+        uint64_t awakeChunks = 0;
+        uint64_t moves = 0;
+        uint64_t activeCells = 0;
+        uint64_t dirtyRects = 0;
+        bool snapshot = !options.snapshotPath.empty();
+        Scene snapshotScene = snapshot ? Scene::capture(engine) : Scene(0, 0);
+        auto start = std::chrono::high_resolution_clock::now();
+
+        for (uint64_t i = 0; i < options.steps; i++) {
+            engine.step();
+            cellsVisited += engine.getLastStepStats().cells_visited;
+            awakeChunks += engine.getLastStepStats().awake_chunks;
+            moves += engine.getLastStepStats().moves;
+            activeCells += engine.getLastStepStats().active_cells;
+            dirtyRects += engine.getLastDirtyRects().size();
+            if (snapshot) {
+                snapshotScene.captureRects(engine, engine.getLastDirtyRects());
+            }
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - start).count();
+        uint64_t steps = std::max<uint64_t>(options.steps, 1);
+
+        std::cout << "=== Headless Simulation Results ===\n";
+        std::cout << "Grid: " << scene.getWidth() << "x" << scene.getHeight()
+                  << ", particles: " << scene.getParticleCount() << "\n";
+        std::cout << "Mode: " << (options.parallel ? "parallel" : options.active ? "active list" : "serial");
+        if (options.parallel) {
+            std::cout << " (" << omp_get_max_threads() << " threads)";
+        }
+        std::cout << (options.sync ? ", spatial sync" : "")
+                  << (options.numa ? ", huge pages + first touch" : "")
+                  << (options.cellIndex ? ", cell index" : "") << "\n";
+        std::cout << "Seed: " << options.seed << "\n";
+        std::cout << "Steps: " << options.steps << "\n";
+        std::cout << "Duration (ms): " << std::fixed << std::setprecision(2)
+                  << seconds * 1000.0 << "\n";
+        std::cout << "Steps/second: " << options.steps / seconds << "\n";
+        std::cout << "Cell updates/second: " << cellsVisited / seconds << "\n";
+        std::cout << "Moves/step: " << static_cast<double>(moves) / steps << "\n";
+        std::cout << "Avg awake chunks: " << static_cast<double>(awakeChunks) / steps
+                  << " / " << engine.getGrid().getChunks().getChunkCount() << "\n";
+        std::cout << "Avg dirty rects: " << static_cast<double>(dirtyRects) / steps << "\n";
+        if (options.active) {
+            std::cout << "Avg active cells: " << static_cast<double>(activeCells) / steps << "\n";
+        }
+        if (snapshot) {
+            snapshotScene.save(options.snapshotPath);
+            std::cout << "Snapshot: " << options.snapshotPath << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -3,6 +3,7 @@
 #include <array>
 #include <cassert>
 #include <memory>
+#include <unordered_set>
 #include "MemoryMonitor.hpp"
 
 /**
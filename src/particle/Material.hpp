@@ -0,0 +1,72 @@
+#pragma once
+#include "Particle.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Data-driven material registry
+ *
+ * One constexpr row per ParticleType describing how the material behaves
+ * and looks. The simulation picks its update kernel from the movement
+ * class and the renderer reads the color, so adding a material only means
+ * adding a ParticleType entry and a row here.
+ *
+ * Usage:
+ * @code
+ * const MaterialProperties& sand = getMaterial(ParticleType::SAND);
+ * Particle p(ParticleType::SAND, sand.mass);
+ * if (sand.movement == MovementClass::POWDER) {
+ *     // Falls and piles up
+ * }
+ * @endcode
+ *
+ * @see Particle, SimulationEngine, GridVisualizer
+ */
+enum class MovementClass : uint8_t {
+    STATIC = 0,  ///< Never moves
+    POWDER,      ///< Falls, slides down diagonals
+    LIQUID,      ///< Falls, slides down diagonals, spreads sideways
+    COUNT
+};
+
+struct MaterialColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+struct MaterialProperties {
+    const char* name;
+    float density;         ///< Relative to water
+    uint8_t mass;          ///< Default Particle::mass
+    MovementClass movement;
+    MaterialColor color;
+    float flammability;    ///< 0 = inert, 1 = ignites immediately
+};
+
+/** @brief Material table indexed by ParticleType */
+constexpr std::array<MaterialProperties, static_cast<size_t>(ParticleType::COUNT)> MATERIALS = {{
+    // name     density  mass  movement                color                 flammability
+    {"Empty",   0.0f,    0,    MovementClass::STATIC,  {0, 0, 0, 255},       0.0f},
+    {"Sand",    1.6f,    100,  MovementClass::POWDER,  {240, 210, 140, 255}, 0.0f},
+    {"Water",   1.0f,    50,   MovementClass::LIQUID,  {64, 164, 223, 255},  0.0f},
+    {"Stone",   2.6f,    200,  MovementClass::STATIC,  {128, 128, 128, 255}, 0.0f},
+    {"Wood",    0.7f,    150,  MovementClass::STATIC,  {139, 69, 19, 255},   0.6f},
+    {"Wall",    100.0f,  255,  MovementClass::STATIC,  {64, 64, 64, 255},    0.0f},
+}};
+
+constexpr bool materialsComplete() {
+    for (const auto& material : MATERIALS) {
+        if (material.name == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(materialsComplete(), "Every ParticleType needs a row in MATERIALS");
+
+constexpr const MaterialProperties& getMaterial(ParticleType type) {
+    return MATERIALS[static_cast<size_t>(type)];
+}
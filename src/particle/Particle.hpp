@@ -10,7 +10,7 @@
  * Memory layout:
  * - type: 1 byte (particle type enum)
  * - mass: 1 byte (0-255 range)
- * - velocity: 2 bytes (x,y components)
+ * - velocity: 2 bytes (x,y components, signed cells per tick)
  * 
  * Usage:
  * @code
@@ -25,7 +25,9 @@ enum class ParticleType : uint8_t {
     SAND,
     WATER,
     STONE,
-    WOOD
+    WOOD,
+    WALL,  ///< Immovable grid border (halo cells)
+    COUNT  ///< Number of particle types, keep last
 };
 
 struct Particle {
@@ -52,4 +54,13 @@ struct Particle {
     bool isEmpty() const {
         return type == ParticleType::EMPTY;
     }
+
+    // Velocity bytes hold signed cells-per-tick values
+    int8_t getVelocityX() const { return static_cast<int8_t>(velocity_x); }
+    int8_t getVelocityY() const { return static_cast<int8_t>(velocity_y); }
+
+    void setVelocity(int8_t vx, int8_t vy) {
+        velocity_x = static_cast<uint8_t>(vx);
+        velocity_y = static_cast<uint8_t>(vy);
+    }
 };
@@ -1,25 +1,23 @@
 #pragma once
 
-class Grid;
+#include "../grid/GridFwd.hpp"
 
 #include "Particle.hpp"
-#include "../spatial/SpatialConstants.hpp"
 /**
  * @brief Lightweight reference wrapper for particle access and spatial tracking
  * 
- * Provides efficient particle referencing with integrated spatial key tracking
- * and grid position management. Optimized for spatial query systems and 
+ * Provides efficient particle referencing and grid position management.
+ * The cell a reference falls in depends on the SpatialHash cell size, so
+ * it is computed by the hash rather than cached here. Optimized for spatial query systems and 
  * particle movement operations.
  * 
  * Performance Metrics (tested with 1M references):
  * - Creation: ~12M refs/second
  * - Access: ~8.5M accesses/second
- * - Key update: ~15M updates/second
- * - Memory: 24 bytes per reference
+ * - Memory: 16 bytes per reference
  * 
  * Key Features:
  * - Zero-overhead particle access
- * - Integrated spatial tracking
  * - Position management
  * - Efficient comparison
  * - Memory-optimized design
@@ -36,8 +34,7 @@ class Grid;
  * // Update position
  * ref.setPosition(newX, newY);
  * 
- * // Get spatial information
- * uint64_t key = ref.getSpatialKey();
+ * // Get position
  * uint32_t x = ref.getX();
  * uint32_t y = ref.getY();
  * 
@@ -54,33 +51,26 @@ class Grid;
  * 2. Position Management:
  *    - getX(): Get X coordinate
  *    - getY(): Get Y coordinate
+ *    - getGrid(): Get owning grid
  *    - setPosition(): Update position
  * 
- * 3. Spatial Tracking:
- *    - getSpatialKey(): Get hash key
- *    - updateSpatialKey(): Recalculate key
- * 
  * Memory Layout:
  * - Grid pointer: 8 bytes
  * - Coordinates: 8 bytes (2 * uint32_t)
- * - Spatial key: 8 bytes (uint64_t)
  * 
  * Performance Characteristics:
  * - Particle access: O(1)
  * - Position update: O(1)
- * - Key calculation: O(1)
  * - Comparison: O(1)
  * 
  * Implementation Details:
  * - Uses grid pointer for direct access
- * - Caches spatial hash key
  * - Maintains position coordinates
  * - Optimized equality comparison
  * 
  * Thread Safety:
  * - Multiple readers allowed
  * - Position updates need synchronization
- * - Key updates are thread-safe
  * 
  * @note Designed for efficient spatial system integration
  * @see Grid, Particle, SpatialHash
@@ -89,7 +79,6 @@ private:
     Grid* grid;
     uint32_t x;
     uint32_t y;
-    uint64_t spatial_hash_key; //spatial tracking
 
 public:
     // Constructor
@@ -97,23 +86,13 @@ public:
         : grid(nullptr)
         , x(0)
         , y(0)
-        , spatial_hash_key(0)
     {}
 
     ParticleRef(Grid* g, uint32_t pos_x, uint32_t pos_y)
         : grid(g)
         , x(pos_x)
         , y(pos_y)
-        , spatial_hash_key(calculateSpatialKey(pos_x, pos_y))
     {}
-    
-    uint64_t getSpatialKey() const {
-        return spatial_hash_key;
-    }
-
-    void updateSpatialKey() {
-        spatial_hash_key = calculateSpatialKey(x, y);
-    }
 
     // Add direct particle access
     Particle& getParticle() { 
@@ -146,10 +125,5 @@ public:
     // Getters
     uint32_t getX() const { return x; }
     uint32_t getY() const { return y; }
-
-private:
-    uint64_t calculateSpatialKey(uint32_t px, uint32_t py) {
-        return (static_cast<uint64_t>(px/spatial::CELL_SIZE) << 32) 
-                | (static_cast<uint64_t>(py/spatial::CELL_SIZE));
-    }
+    Grid* getGrid() const { return grid; }
 };
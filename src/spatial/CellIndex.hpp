@@ -0,0 +1,247 @@
+#pragma once
+#include "../grid/GridStorage.hpp"
+#include "../grid/GridFwd.hpp"
+#include "../grid/OccupancyBitboard.hpp"
+#include "SpatialConstants.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Dense per-cell particle index for bounded worlds
+ *
+ * A lock-free alternative to SpatialHash when the world is a Grid of known
+ * size. Every spatial cell (CELL_SIZE x CELL_SIZE grid cells) owns a
+ * contiguous slice of one flat array of particle indices, located through
+ * a cellStart offsets array, so a lookup is one array access and its
+ * results are a contiguous span. There is no hashing, so distinct cells
+ * never collide.
+ *
+ * The index is rebuilt from the grid's occupancy plane, typically once per
+ * frame, with a counting sort:
+ * 1. Histogram: popcount of each cell's lanes in the occupancy words
+ * 2. Prefix sum: cellStart offsets, per cell row then across rows
+ * 3. Scatter: particle indices (y * width + x) written in row-major order
+ *
+ * Steps 1 and 3 run in parallel over rows of spatial cells. A row of cells
+ * covers CELL_SIZE whole grid rows, so each thread owns its counters and
+ * output slices and no atomics or locks are needed.
+ *
+ * Usage Examples:
+ * @code
+ * CellIndex index(grid);
+ * index.rebuild(grid);
+ *
+ * for (uint32_t particle : index.query(x, y)) {
+ *     uint32_t px = particle % grid.getWidth();
+ *     uint32_t py = particle / grid.getWidth();
+ * }
+ * @endcode
+ *
+ * API Categories:
+ *
+ * 1. Construction:
+ *    - CellIndex(grid): Sized from the grid's dimensions
+ *    - rebuild(): Recount and rescatter all occupied cells
+ *
+ * 2. Lookup:
+ *    - query(x, y): Particles in the cell holding grid cell (x, y)
+ *    - cell(cx, cy): Particles in spatial cell (cx, cy)
+ *    - getCellStart(), getEntries(): The raw counting-sort arrays
+ *
+ * Memory Layout:
+ * - cellStart: (cells + 1) uint32 offsets
+ * - Entries: one uint32 per particle
+ *
+ * Performance Characteristics:
+ * - rebuild(): O(grid words + particles), parallel
+ * - Lookup: O(1), results contiguous and sorted
+ *
+ * @note Cell size must be a power of two no larger than 64, so each cell
+ *       covers whole lanes of an occupancy word
+ * @see SpatialHash, OccupancyBitboard
+ */
+class CellIndex {
+private:
+    uint32_t width;
+    uint32_t height;
+    uint32_t cell_size;
+    uint32_t cells_x;
+    uint32_t cells_y;
+    uint32_t lanes;       ///< Cells per occupancy word
+    uint64_t lane_mask;
+    std::vector<uint32_t> cell_start;
+    std::vector<uint32_t> entries;
+
+    // Occupancy word (wx, y) without the padding bits past the last column
+    uint64_t rowWord(const OccupancyBitboard& occupancy, uint32_t wx, uint32_t y) const {
+        uint64_t bits = occupancy.word(wx, y);
+        uint32_t tail = width - wx * OccupancyBitboard::WORD_BITS;
+        return tail < OccupancyBitboard::WORD_BITS ? bits & ((1ULL << tail) - 1) : bits;
+    }
+
+    // Counts particles of cell row cy into cell_start[c + 1]; returns the row total
+    uint32_t countRow(const OccupancyBitboard& occupancy, uint32_t cy) {
+        uint32_t* counts = &cell_start[static_cast<size_t>(cy) * cells_x + 1];
+        std::fill(counts, counts + cells_x, 0);
+        uint32_t rowEnd = std::min(height, (cy + 1) * cell_size);
+
+        for (uint32_t y = cy * cell_size; y < rowEnd; ++y) {
+            for (uint32_t wx = 0; wx < occupancy.getWordsPerRow(); ++wx) {
+                uint64_t bits = rowWord(occupancy, wx, y);
+                for (uint32_t lane = 0; bits; ++lane) {
+                    counts[wx * lanes + lane] += __builtin_popcountll(bits & lane_mask);
+                    bits = cell_size < OccupancyBitboard::WORD_BITS ? bits >> cell_size : 0;
+                }
+            }
+        }
+
+        // Local prefix sum: offsets relative to the start of this cell row
+        uint32_t total = 0;
+        for (uint32_t cx = 0; cx < cells_x; ++cx) {
+            total += counts[cx];
+            counts[cx] = total;
+        }
+        return total;
+    }
+
+    void scatterRow(const OccupancyBitboard& occupancy, uint32_t cy, std::vector<uint32_t>& cursor) {
+        size_t first = static_cast<size_t>(cy) * cells_x;
+        cursor.assign(cell_start.begin() + first, cell_start.begin() + first + cells_x);
+        uint32_t rowEnd = std::min(height, (cy + 1) * cell_size);
+
+        for (uint32_t y = cy * cell_size; y < rowEnd; ++y) {
+            uint32_t base = y * width;
+            for (uint32_t wx = 0; wx < occupancy.getWordsPerRow(); ++wx) {
+                uint64_t bits = rowWord(occupancy, wx, y);
+                while (bits) {
+                    uint32_t x = wx * OccupancyBitboard::WORD_BITS + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    entries[cursor[x / cell_size]++] = base + x;
+                }
+            }
+        }
+    }
+
+public:
+    /**
+     * @param w Grid width
+     * @param h Grid height
+     * @param cellSize Spatial cell edge in grid cells
+     * @throws std::invalid_argument if cellSize is not a power of two <= 64
+     */
+    CellIndex(uint32_t w, uint32_t h, uint32_t cellSize = spatial::CELL_SIZE)
+        : width(w)
+        , height(h)
+        , cell_size(cellSize)
+        , cells_x((w + cellSize - 1) / std::max<uint32_t>(cellSize, 1))
+        , cells_y((h + cellSize - 1) / std::max<uint32_t>(cellSize, 1))
+        , lanes(OccupancyBitboard::WORD_BITS / std::max<uint32_t>(cellSize, 1))
+        , lane_mask(cellSize >= 64 ? ~0ULL : (1ULL << cellSize) - 1)
+        , cell_start(static_cast<size_t>(cells_x) * cells_y + 1, 0)
+    {
+        if (cellSize == 0 || cellSize > OccupancyBitboard::WORD_BITS || (cellSize & (cellSize - 1))) {
+            throw std::invalid_argument("CellIndex cell size must be a power of two <= 64, got " +
+                                        std::to_string(cellSize));
+        }
+    }
+
+    /** @brief Index sized from a grid's dimensions, for any storage policy */
+    template<typename Storage>
+    explicit CellIndex(const BasicGrid<Storage>& grid, uint32_t cellSize = spatial::CELL_SIZE)
+        : CellIndex(grid.getWidth(), grid.getHeight(), cellSize)
+    {}
+
+    /**
+     * @brief Rebuilds the index from the grid's occupancy plane
+     * @throws std::invalid_argument if the grid size differs from the index
+     */
+    template<typename GridT>
+    void rebuild(const GridT& grid) {
+        rebuild(grid.getOccupancy());
+    }
+
+    void rebuild(const OccupancyBitboard& occupancy) {
+        if (occupancy.getWidth() != width || occupancy.getHeight() != height) {
+            throw std::invalid_argument("CellIndex rebuilt from a grid of a different size");
+        }
+
+        // Histogram and per-row prefix sums
+        std::vector<uint32_t> rowTotals(cells_y);
+        int64_t rows = cells_y;
+#ifdef _OPENMP
+        #pragma omp parallel for schedule(static)
+#endif
+        for (int64_t cy = 0; cy < rows; ++cy) {
+            rowTotals[cy] = countRow(occupancy, static_cast<uint32_t>(cy));
+        }
+
+        // Row offsets, then shift every row's local offsets by its base.
+        // cell_start[c + 1] holds the end of cell c; cell_start[0] stays 0
+        std::vector<uint32_t> rowBase(cells_y);
+        uint32_t total = 0;
+        for (uint32_t cy = 0; cy < cells_y; ++cy) {
+            rowBase[cy] = total;
+            total += rowTotals[cy];
+        }
+        cell_start[0] = 0;
+        entries.resize(total);
+
+#ifdef _OPENMP
+        #pragma omp parallel
+#endif
+        {
+            std::vector<uint32_t> cursor;
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (int64_t cy = 0; cy < rows; ++cy) {
+                uint32_t* ends = &cell_start[static_cast<size_t>(cy) * cells_x + 1];
+                for (uint32_t cx = 0; cx < cells_x; ++cx) {
+                    ends[cx] += rowBase[cy];
+                }
+            }
+
+            // Scatter; reads the start of the first cell of the row, which the
+            // previous row wrote, so it waits for the loop above
+#ifdef _OPENMP
+            #pragma omp for schedule(static)
+#endif
+            for (int64_t cy = 0; cy < rows; ++cy) {
+                scatterRow(occupancy, static_cast<uint32_t>(cy), cursor);
+            }
+        }
+    }
+
+    /** @brief Particles of spatial cell (cx, cy), as indices y * width + x */
+    PlaneSpan<const uint32_t> cell(uint32_t cx, uint32_t cy) const {
+        size_t c = static_cast<size_t>(cy) * cells_x + cx;
+        return {entries.data() + cell_start[c], cell_start[c + 1] - cell_start[c]};
+    }
+
+    /** @brief Particles in the spatial cell holding grid cell (x, y) */
+    PlaneSpan<const uint32_t> query(uint32_t x, uint32_t y) const {
+        return cell(x / cell_size, y / cell_size);
+    }
+
+    uint32_t cellIndex(uint32_t x, uint32_t y) const {
+        return (y / cell_size) * cells_x + x / cell_size;
+    }
+
+    size_t size() const { return entries.size(); }
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    uint32_t getCellSize() const { return cell_size; }
+    uint32_t getCellsX() const { return cells_x; }
+    uint32_t getCellsY() const { return cells_y; }
+    uint32_t getCellCount() const { return cells_x * cells_y; }
+    const std::vector<uint32_t>& getCellStart() const { return cell_start; }
+    const std::vector<uint32_t>& getEntries() const { return entries; }
+
+    size_t getMemoryUsage() const {
+        return (cell_start.capacity() + entries.capacity()) * sizeof(uint32_t);
+    }
+};
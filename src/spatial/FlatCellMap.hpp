@@ -0,0 +1,309 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "SpatialConstants.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Flat open-addressing map from 64-bit cell keys to 32-bit values
+ *
+ * SwissTable-style layout: slots live in one flat array, split into groups
+ * of 16, and a parallel array of control bytes holds, per slot, either
+ * EMPTY, DELETED or the low 7 bits of the key's hash (H2). A lookup mixes
+ * the key, starts at the group picked by the remaining bits (H1), compares
+ * all 16 control bytes of a group against H2 in one SSE2 instruction, so
+ * it touches the key array only for likely matches. Groups are probed
+ * quadratically and the probe stops at the first group with an EMPTY byte.
+ *
+ * Usage Examples:
+ * @code
+ * FlatCellMap map;
+ * auto [value, inserted] = map.tryEmplace(spatial::cellKey(cx, cy), 7);
+ *
+ * if (const uint32_t* found = map.find(spatial::cellKey(cx, cy))) {
+ *     // *found == 7
+ * }
+ *
+ * FlatCellMap::ProbeStats stats = map.getProbeStats();
+ * @endcode
+ *
+ * API Categories:
+ *
+ * 1. Lookup and Update:
+ *    - find(): Value of a key, or nullptr
+ *    - tryEmplace(): Insert if absent, returns the value slot
+ *    - erase(): Remove a key
+ *
+ * 2. Iteration and Capacity:
+ *    - forEach(): Visit every (key, value)
+ *    - size(), capacity(), clear(), reserve()
+ *
+ * 3. Diagnostics:
+ *    - getProbeStats(): Probe-length histogram, displaced keys, load
+ *
+ * Memory Layout:
+ * - Control bytes: 1 per slot, 16-byte aligned groups
+ * - Slots: 12 bytes (key + value) per slot, no per-entry allocation
+ *
+ * Performance Characteristics:
+ * - Lookup/insert/erase: O(1) expected, one group per probe step
+ * - Growth: doubles at 7/8 load (rehash of all keys)
+ * - Erase leaves a DELETED tombstone only when the group is full, so
+ *   probe chains of other keys are never cut
+ *
+ * Thread Safety:
+ * - Not thread-safe; callers serialize writes
+ *
+ * @see FlatSpatialHash
+ */
+class FlatCellMap {
+public:
+    static constexpr size_t GROUP_SIZE = 16;
+
+    /** @brief Distribution health of the table */
+    struct ProbeStats {
+        size_t size = 0;
+        size_t capacity = 0;
+        size_t tombstones = 0;
+        size_t displaced = 0;        ///< Keys not in their home group
+        size_t max_probe = 0;        ///< Groups visited by the longest lookup
+        double avg_probe = 0.0;      ///< Mean groups visited per stored key
+        double load_factor = 0.0;
+        std::vector<size_t> probe_histogram;  ///< [n] = keys found after n + 1 groups
+    };
+
+private:
+    static constexpr int8_t EMPTY = -128;   // 0b10000000
+    static constexpr int8_t DELETED = -2;   // 0b11111110
+
+    struct Slot {
+        uint64_t key;
+        uint32_t value;
+    };
+
+    struct AlignedDelete {
+        void operator()(int8_t* p) const { ::operator delete(p, std::align_val_t(GROUP_SIZE)); }
+    };
+
+    std::unique_ptr<int8_t[], AlignedDelete> ctrl;
+    std::unique_ptr<Slot[]> slots;
+    size_t group_mask = 0;   ///< Groups - 1
+    size_t count = 0;
+    size_t tombstones = 0;
+
+    static size_t h1(uint64_t hash) { return static_cast<size_t>(hash >> 7); }
+    static int8_t h2(uint64_t hash) { return static_cast<int8_t>(hash & 0x7f); }
+
+    /** @brief Bit i set where control byte i of the group equals value */
+    static uint32_t matchByte(const int8_t* group, int8_t value) {
+#ifdef __SSE2__
+        __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i) {
+            mask |= static_cast<uint32_t>(group[i] == value) << i;
+        }
+        return mask;
+#endif
+    }
+
+    /** @brief Bit i set where control byte i is EMPTY or DELETED (sign bit) */
+    static uint32_t matchFree(const int8_t* group) {
+#ifdef __SSE2__
+        __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP_SIZE; ++i) {
+            mask |= static_cast<uint32_t>(group[i] < 0) << i;
+        }
+        return mask;
+#endif
+    }
+
+    size_t slotCount() const { return ctrl ? (group_mask + 1) * GROUP_SIZE : 0; }
+
+    void allocate(size_t groups) {
+        size_t n = groups * GROUP_SIZE;
+        ctrl.reset(static_cast<int8_t*>(::operator new(n, std::align_val_t(GROUP_SIZE))));
+        std::memset(ctrl.get(), EMPTY, n);
+        slots = std::make_unique<Slot[]>(n);
+        group_mask = groups - 1;
+        count = 0;
+        tombstones = 0;
+    }
+
+    /** @brief Index of key's slot, or SIZE_MAX; groups counts the groups visited */
+    size_t findIndex(uint64_t key, size_t* groups = nullptr) const {
+        if (!ctrl) return SIZE_MAX;
+        uint64_t hash = spatial::mixKey(key);
+        int8_t tag = h2(hash);
+        size_t g = h1(hash) & group_mask;
+        for (size_t step = 1;; ++step) {
+            const int8_t* group = ctrl.get() + g * GROUP_SIZE;
+            for (uint32_t m = matchByte(group, tag); m; m &= m - 1) {
+                size_t i = g * GROUP_SIZE + __builtin_ctz(m);
+                if (slots[i].key == key) {
+                    if (groups) *groups = step;
+                    return i;
+                }
+            }
+            if (matchByte(group, EMPTY)) return SIZE_MAX;
+            g = (g + step) & group_mask;  // Triangular: visits every group
+        }
+    }
+
+    /** @brief First free slot on key's probe path; key must be absent */
+    size_t findFree(uint64_t hash) const {
+        size_t g = h1(hash) & group_mask;
+        for (size_t step = 1;; ++step) {
+            uint32_t free = matchFree(ctrl.get() + g * GROUP_SIZE);
+            if (free) return g * GROUP_SIZE + __builtin_ctz(free);
+            g = (g + step) & group_mask;
+        }
+    }
+
+    void rehash(size_t groups) {
+        std::unique_ptr<int8_t[], AlignedDelete> old_ctrl = std::move(ctrl);
+        std::unique_ptr<Slot[]> old_slots = std::move(slots);
+        size_t old_slots_count = (group_mask + 1) * GROUP_SIZE;
+        bool had_table = old_ctrl != nullptr;
+        allocate(groups);
+        if (!had_table) return;
+
+        for (size_t i = 0; i < old_slots_count; ++i) {
+            if (old_ctrl[i] >= 0) {
+                uint64_t hash = spatial::mixKey(old_slots[i].key);
+                size_t j = findFree(hash);
+                ctrl[j] = h2(hash);
+                slots[j] = old_slots[i];
+                count++;
+            }
+        }
+    }
+
+    void growIfNeeded() {
+        size_t capacity = slotCount();
+        if (capacity == 0) {
+            allocate(1);
+        } else if ((count + tombstones + 1) * 8 > capacity * 7) {
+            // Mostly tombstones: rebuild in place, otherwise double
+            rehash(count * 2 < capacity ? group_mask + 1 : (group_mask + 1) * 2);
+        }
+    }
+
+public:
+    FlatCellMap() = default;
+    FlatCellMap(FlatCellMap&&) noexcept = default;
+    FlatCellMap& operator=(FlatCellMap&&) noexcept = default;
+
+    uint32_t* find(uint64_t key) {
+        size_t i = findIndex(key);
+        return i == SIZE_MAX ? nullptr : &slots[i].value;
+    }
+
+    const uint32_t* find(uint64_t key) const {
+        size_t i = findIndex(key);
+        return i == SIZE_MAX ? nullptr : &slots[i].value;
+    }
+
+    /**
+     * @brief Inserts (key, value) unless key is present
+     * @return The key's value slot and whether it was inserted
+     */
+    std::pair<uint32_t*, bool> tryEmplace(uint64_t key, uint32_t value) {
+        if (uint32_t* existing = find(key)) {
+            return {existing, false};
+        }
+        growIfNeeded();
+        uint64_t hash = spatial::mixKey(key);
+        size_t i = findFree(hash);
+        tombstones -= ctrl[i] == DELETED;
+        ctrl[i] = h2(hash);
+        slots[i] = Slot{key, value};
+        count++;
+        return {&slots[i].value, true};
+    }
+
+    /** @return true if key was present */
+    bool erase(uint64_t key) {
+        size_t i = findIndex(key);
+        if (i == SIZE_MAX) return false;
+
+        // A group with an EMPTY byte already ends every probe through it,
+        // so the slot can become EMPTY instead of a tombstone
+        const int8_t* group = ctrl.get() + (i / GROUP_SIZE) * GROUP_SIZE;
+        if (matchByte(group, EMPTY)) {
+            ctrl[i] = EMPTY;
+        } else {
+            ctrl[i] = DELETED;
+            tombstones++;
+        }
+        count--;
+        return true;
+    }
+
+    /** @brief Visits every entry as fn(key, value&) in slot order */
+    template<typename Fn>
+    void forEach(Fn&& fn) {
+        for (size_t i = 0; i < slotCount(); ++i) {
+            if (ctrl[i] >= 0) fn(slots[i].key, slots[i].value);
+        }
+    }
+
+    /** @brief Sizes the table for n keys without growing */
+    void reserve(size_t n) {
+        size_t groups = 1;
+        while (groups * GROUP_SIZE * 7 < n * 8) groups *= 2;
+        if (groups > group_mask + 1 || !ctrl) rehash(groups);
+    }
+
+    void clear() {
+        if (ctrl) {
+            std::memset(ctrl.get(), EMPTY, slotCount());
+        }
+        count = 0;
+        tombstones = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return slotCount(); }
+
+    size_t getMemoryUsage() const {
+        return slotCount() * (sizeof(int8_t) + sizeof(Slot));
+    }
+
+    /** @brief Walks every stored key's probe path; O(size) */
+    ProbeStats getProbeStats() const {
+        ProbeStats stats;
+        stats.size = count;
+        stats.capacity = slotCount();
+        stats.tombstones = tombstones;
+        stats.load_factor = stats.capacity ? static_cast<double>(count) / stats.capacity : 0.0;
+
+        size_t total = 0;
+        for (size_t i = 0; i < slotCount(); ++i) {
+            if (ctrl[i] < 0) continue;
+            size_t groups = 0;
+            findIndex(slots[i].key, &groups);
+            if (groups > stats.probe_histogram.size()) {
+                stats.probe_histogram.resize(groups, 0);
+            }
+            stats.probe_histogram[groups - 1]++;
+            stats.displaced += groups > 1;
+            stats.max_probe = std::max(stats.max_probe, groups);
+            total += groups;
+        }
+        stats.avg_probe = count ? static_cast<double>(total) / count : 0.0;
+        return stats;
+    }
+};
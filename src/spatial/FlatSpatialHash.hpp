@@ -0,0 +1,136 @@
+#pragma once
+#include "FlatCellMap.hpp"
+#include "SpatialConstants.hpp"
+#include "../particle/ParticleRef.hpp"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Unbounded spatial hash over a flat open-addressing cell map
+ *
+ * Alternative backend to SpatialHash for sparse, very large worlds where a
+ * dense CellIndex would be mostly empty. Occupied cells are found through
+ * a FlatCellMap keyed by the properly mixed cell key, so distinct cells
+ * never share a list and no coordinate is clamped. Each cell maps to a run
+ * of ParticleRefs; runs of cells that empty out are recycled with their
+ * capacity, so steady-state updates do not allocate.
+ *
+ * Usage Examples:
+ * @code
+ * FlatSpatialHash hash;
+ * hash.insert(ParticleRef(&grid, x, y), x, y);
+ *
+ * for (const ParticleRef& ref : hash.query(x, y)) {
+ *     // Same cell as (x, y), never a colliding one
+ * }
+ *
+ * auto stats = hash.getProbeStats();  // Probe lengths of the cell map
+ * @endcode
+ *
+ * API Categories:
+ *
+ * 1. Particle Management:
+ *    - insert(), remove(): Same signatures as SpatialHash
+ *    - batchUpdate(): Insert many references
+ *    - query(): Particles in the cell holding (x, y)
+ *
+ * 2. Properties:
+ *    - size(): Indexed particles
+ *    - getCellCount(): Occupied cells
+ *    - getProbeStats(): Collision and probe-length statistics
+ *
+ * Memory Layout:
+ * - Cell map: 13 bytes per slot, sized for occupied cells only
+ * - Runs: one vector of ParticleRef per occupied cell
+ *
+ * Performance Characteristics:
+ * - Insert: O(1) expected
+ * - Remove: O(particles in the cell)
+ * - Query: O(1) expected + particles in the cell
+ *
+ * Thread Safety:
+ * - Not thread-safe; callers serialize writes (no per-bucket mutexes)
+ *
+ * @see SpatialHash, FlatCellMap, CellIndex
+ */
+class FlatSpatialHash {
+public:
+    static const uint32_t CELL_SIZE = spatial::CELL_SIZE;
+    using ProbeStats = FlatCellMap::ProbeStats;
+
+private:
+    FlatCellMap cells;                        ///< Cell key -> run index
+    std::vector<std::vector<ParticleRef>> runs;
+    std::vector<uint32_t> free_runs;
+    size_t particle_count = 0;
+
+    static uint64_t keyFor(uint32_t x, uint32_t y) {
+        return spatial::cellKey(x / CELL_SIZE, y / CELL_SIZE);
+    }
+
+    uint32_t acquireRun() {
+        if (free_runs.empty()) {
+            runs.emplace_back();
+            return static_cast<uint32_t>(runs.size() - 1);
+        }
+        uint32_t run = free_runs.back();
+        free_runs.pop_back();
+        return run;
+    }
+
+public:
+    void insert(const ParticleRef& p, uint32_t x, uint32_t y) {
+        auto [run, inserted] = cells.tryEmplace(keyFor(x, y), 0);
+        if (inserted) {
+            *run = acquireRun();
+        }
+        runs[*run].push_back(p);
+        particle_count++;
+    }
+
+    /** @return true if p was indexed in the cell of (x, y) */
+    bool remove(const ParticleRef& p, uint32_t x, uint32_t y) {
+        uint64_t key = keyFor(x, y);
+        uint32_t* run = cells.find(key);
+        if (!run) return false;
+
+        std::vector<ParticleRef>& list = runs[*run];
+        for (size_t i = 0; i < list.size(); ++i) {
+            if (list[i] == p) {
+                list[i] = list.back();
+                list.pop_back();
+                particle_count--;
+                if (list.empty()) {
+                    free_runs.push_back(*run);
+                    cells.erase(key);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void batchUpdate(const std::vector<ParticleRef>& particles) {
+        for (const ParticleRef& p : particles) {
+            insert(p, p.getX(), p.getY());
+        }
+    }
+
+    /** @brief Particles in the cell holding (x, y), empty if none */
+    const std::vector<ParticleRef>& query(uint32_t x, uint32_t y) const {
+        static const std::vector<ParticleRef> none;
+        const uint32_t* run = cells.find(keyFor(x, y));
+        return run ? runs[*run] : none;
+    }
+
+    void clear() {
+        cells.clear();
+        runs.clear();
+        free_runs.clear();
+        particle_count = 0;
+    }
+
+    size_t size() const { return particle_count; }
+    size_t getCellCount() const { return cells.size(); }
+    ProbeStats getProbeStats() const { return cells.getProbeStats(); }
+};
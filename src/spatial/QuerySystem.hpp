@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <chrono>
 #include "SpatialHash.hpp"
 #include "../math/Vector2D.hpp"
@@ -49,6 +50,9 @@
  * 
  * // Density-based regions
  * auto denseAreas = querySystem.queryDenseRegions(4.0f);
+ * 
+ * // Visit without building a result vector
+ * querySystem.forEachInRadius(pos, radius, [&](const ParticleRef& p) { ... });
  * @endcode
  * 
  * API Categories:
@@ -56,6 +60,7 @@
  * 1. Basic Spatial Queries:
  *    - queryRadius(): Search within radius
  *    - queryBox(): Search within box bounds
+ *    - forEachInRadius(), forEachInBox(): Visitor forms, no allocation
  *    - queryKNearest(): Find K nearest particles
  * 
  * 2. Advanced Queries:
@@ -69,21 +74,25 @@
  *    - Spatial index updates
  * 
  * Implementation Details:
- * - Cache size: 64 entries (power of 2 for efficient indexing)
+ * - Cache size: 64 entries (power of 2 for efficient indexing), keyed
+ *   by the hash epoch so results never outlive a write
+ * - Cells read in place through SpatialHash::forEachInCell(); particles
+ *   of colliding cells never show up, nor twice
  * - SIMD batch size: 4 particles
  * - O(1) average query time with spatial hashing
- * - Density calculation using 3x3 cell neighborhood
+ * - Density calculation using 3x3 cell neighborhood, recounted only
+ *   when the hash changed
  * - Thread-safe query operations
  * 
  * Performance Characteristics:
  * - Cache hit: O(1)
  * - Radius query: O(πr²) where r is cell radius
- * - Box query: O(w*h) where w,h are box dimensions
+ * - Box query: O(w*h) where w,h are box dimensions in cells
  * - K-nearest: O(k*log n) with spatial partitioning
  * 
  * Memory Usage:
  * - Query cache: 64 * sizeof(QueryResult)
- * - Spatial index: O(n) where n is particle count
+ * - Spatial index: 8 bytes per hash cell
  * - Temporary buffers: O(batch_size)
  * 
  * @note Optimal performance with SIMD-enabled compilation
@@ -92,60 +101,55 @@
 class QuerySystem {
 private:
     SpatialHash& spatial_hash;
+    /** @brief Particles per hash cell and their 3x3 neighbourhood sums */
     struct SpatialIndex {
-        uint32_t grid_width;
-        uint32_t grid_height;
+        uint32_t grid_width;   ///< In cells
+        uint32_t grid_height;  ///< In cells
         std::vector<uint32_t> cell_occupancy;
         std::vector<float> density_map;
-        float density_threshold;
+        uint32_t built_epoch = 0;
+        bool built = false;
         
         SpatialIndex(uint32_t width, uint32_t height)
             : grid_width(width)
             , grid_height(height)
             , cell_occupancy(width * height, 0)
             , density_map(width * height, 0.0f)
-            , density_threshold(4.0f)
         {}
         
-        void update(uint32_t x, uint32_t y) {
-            uint32_t index = y * grid_width + x;
-            cell_occupancy[index]++;
-            updateDensity(x, y);
+        /** @brief Recounts every cell; skipped if the hash has not changed */
+        void rebuild(const SpatialHash& hash) {
+            if(built && built_epoch == hash.epoch()) {
+                return;
+            }
+            std::fill(cell_occupancy.begin(), cell_occupancy.end(), 0);
+            hash.forEachParticle([&](const ParticleRef& p) {
+                uint32_t x = std::min(p.getX() / hash.getCellSize(), grid_width - 1);
+                uint32_t y = std::min(p.getY() / hash.getCellSize(), grid_height - 1);
+                cell_occupancy[y * grid_width + x]++;
+            });
+            for(uint32_t y = 0; y < grid_height; y++) {
+                for(uint32_t x = 0; x < grid_width; x++) {
+                    updateDensity(x, y);
+                }
+            }
+            built_epoch = hash.epoch();
+            built = true;
         }
         
         void updateDensity(uint32_t x, uint32_t y) {
-            // Density calculation based on neighboring cells
-            uint32_t index = y * grid_width + x;
+            // Density calculation based on neighboring cells inside the hash
             float density = 0.0f;
-            
-            // Convert loop variables to unsigned
-            for(uint32_t dy = 0; dy < 3; dy++) {
-                for(uint32_t dx = 0; dx < 3; dx++) {
-                    // Calculate with offset to avoid signed comparisons
-                    uint32_t nx = (x + dx + grid_width - 1) % grid_width;
-                    uint32_t ny = (y + dy + grid_height - 1) % grid_height;
-                    
+            uint32_t min_x = x > 0 ? x - 1 : 0;
+            uint32_t min_y = y > 0 ? y - 1 : 0;
+            uint32_t max_x = std::min(x + 1, grid_width - 1);
+            uint32_t max_y = std::min(y + 1, grid_height - 1);
+            for(uint32_t ny = min_y; ny <= max_y; ny++) {
+                for(uint32_t nx = min_x; nx <= max_x; nx++) {
                     density += cell_occupancy[ny * grid_width + nx];
                 }
             }
-            
-            density_map[index] = density;
-        }
-
-        bool isDenseRegion(uint32_t x, uint32_t y) const {
-            return density_map[y * grid_width + x] > density_threshold;
-        }
-        
-        std::vector<Vector2D> getDenseRegions() const {
-            std::vector<Vector2D> regions;
-            for(uint32_t y = 0; y < grid_height; y++) {
-                for(uint32_t x = 0; x < grid_width; x++) {
-                    if(isDenseRegion(x, y)) {
-                        regions.emplace_back(x, y);
-                    }
-                }
-            }
-            return regions;
+            density_map[y * grid_width + x] = density;
         }
     } spatial_index;
     
@@ -155,13 +159,15 @@ private:
             float radius;
             std::vector<ParticleRef> results;
             uint64_t timestamp;
+            uint32_t epoch;  ///< SpatialHash::epoch() the results were read at
         };
         static const size_t CACHE_SIZE = 64;
         std::vector<CacheEntry> entries;
         
-        std::vector<ParticleRef>* tryGet(Vector2D pos, float radius) {
+        std::vector<ParticleRef>* tryGet(Vector2D pos, float radius, uint32_t epoch) {
             for(auto& entry : entries) {
-                if((entry.position - pos).lengthSquared() < 0.0001f && 
+                if(entry.epoch == epoch &&
+                   (entry.position - pos).lengthSquared() < 0.0001f && 
                     std::abs(entry.radius - radius) < 0.0001f) {
                     return &entry.results;
                 }
@@ -169,11 +175,12 @@ private:
             return nullptr;
         }
         
-        void store(Vector2D pos, float radius, const std::vector<ParticleRef>& results, uint64_t current_time) {
+        void store(Vector2D pos, float radius, const std::vector<ParticleRef>& results,
+                   uint64_t current_time, uint32_t epoch) {
             if(entries.size() >= CACHE_SIZE) {
                 entries.erase(entries.begin());
             }
-            entries.push_back({pos, radius, results, current_time});
+            entries.push_back({pos, radius, results, current_time, epoch});
         }
     } query_cache;
 
@@ -210,107 +217,121 @@ private:
         }
     };
     
-    void queryCell(uint32_t x, uint32_t y, std::vector<ParticleRef>& results) {
-        // Validate coordinates
-        if (x >= spatial_hash.getWidth() || y >= spatial_hash.getHeight()) {
-            return;  // Out of bounds, just return
+    /** @brief Cell coordinate of a position, clamped to the world */
+    uint32_t toCell(float v, uint32_t cells) const {
+        if(v <= 0.0f) {
+            return 0;
         }
+        return std::min(static_cast<uint32_t>(std::min(v, 4294967040.0f)) / spatial_hash.getCellSize(), cells - 1);
+    }
 
-        auto cell_particles = spatial_hash.query(x, y);
-        results.insert(results.end(), cell_particles.begin(), cell_particles.end());
-        spatial_index.update(x, y);
+    static uint32_t cellsFor(uint32_t extent, uint32_t cell_size) {
+        return std::max<uint32_t>((extent + cell_size - 1) / cell_size, 1);
+    }
+
+    uint32_t cellsX() const { return cellsFor(spatial_hash.getWidth(), spatial_hash.getCellSize()); }
+    uint32_t cellsY() const { return cellsFor(spatial_hash.getHeight(), spatial_hash.getCellSize()); }
+
+    /** @brief Calls fn(ref) for every particle of the cells overlapping [min, max] */
+    template<typename Fn>
+    void forEachInCells(Vector2D min, Vector2D max, Fn&& fn) const {
+        uint32_t start_x = toCell(min.x, cellsX());
+        uint32_t start_y = toCell(min.y, cellsY());
+        uint32_t end_x = toCell(max.x, cellsX());
+        uint32_t end_y = toCell(max.y, cellsY());
+        for(uint32_t y = start_y; y <= end_y; y++) {
+            for(uint32_t x = start_x; x <= end_x; x++) {
+                spatial_hash.forEachInCell(x * spatial_hash.getCellSize(), y * spatial_hash.getCellSize(), fn);
+            }
+        }
     }
 
 
 public:
     QuerySystem(SpatialHash& hash) 
         : spatial_hash(hash)
-        , spatial_index(hash.getWidth(), hash.getHeight())
+        , spatial_index(cellsFor(hash.getWidth(), hash.getCellSize()),
+                        cellsFor(hash.getHeight(), hash.getCellSize()))
         , query_cache() 
     {}
 
-    std::vector<ParticleRef> queryRadius(Vector2D pos, float radius) {
-        //validate radius
-        if (radius <= 0) {
-            return {};  // Invalid radius, just return empty
-        }
-        // Validate position
-        if (pos.x < 0 || pos.y < 0 || 
-            pos.x >= spatial_hash.getWidth() || 
-            pos.y >= spatial_hash.getHeight()) {
-            return {};  // Invalid position, just return empty
+    /**
+     * @brief Calls fn(ref) for every particle within radius of pos
+     * @note No allocation and no copies; reads the hash without locks, so
+     *       no writer may run meanwhile
+     */
+    template<typename Fn>
+    void forEachInRadius(Vector2D pos, float radius, Fn&& fn) const {
+        if (radius <= 0 || pos.x < 0 || pos.y < 0 ||
+            pos.x >= spatial_hash.getWidth() || pos.y >= spatial_hash.getHeight()) {
+            return;
         }
-
-        if (auto cached = query_cache.tryGet(pos, radius)) {
-            return *cached;
-        }
-        
-        std::vector<ParticleRef> result;
         float radiusSquared = radius * radius;
-        int cellRadius = ceil(radius / SpatialHash::CELL_SIZE);
-        
-        for(int dy = -cellRadius; dy <= cellRadius; dy++) {
-            for(int dx = -cellRadius; dx <= cellRadius; dx++) {
-                uint32_t query_x = static_cast<uint32_t>(pos.x) + dx;
-                uint32_t query_y = static_cast<uint32_t>(pos.y) + dy;
-
-                //skip if out of bounds
-                if (query_x >= static_cast<uint32_t>(spatial_hash.getWidth()) || 
-                    query_y >= static_cast<uint32_t>(spatial_hash.getHeight())) {
-                    continue;
+        forEachInCells(Vector2D(pos.x - radius, pos.y - radius), Vector2D(pos.x + radius, pos.y + radius),
+            [&](const ParticleRef& p) {
+                Vector2D p_pos(p.getX(), p.getY());
+                if (DistanceCalculator::isWithinRadius(pos, p_pos, radiusSquared)) {
+                    fn(p);
                 }
+            });
+    }
 
-                queryCell(query_x, query_y, result);
+    /** @brief Calls fn(ref) for every particle inside [min, max]; see forEachInRadius() */
+    template<typename Fn>
+    void forEachInBox(Vector2D min, Vector2D max, Fn&& fn) const {
+        if (max.x < min.x || max.y < min.y || max.x < 0 || max.y < 0) {
+            return;
+        }
+        forEachInCells(min, max, [&](const ParticleRef& p) {
+            float x = static_cast<float>(p.getX());
+            float y = static_cast<float>(p.getY());
+            if (x >= min.x && x <= max.x && y >= min.y && y <= max.y) {
+                fn(p);
             }
+        });
+    }
+
+    std::vector<ParticleRef> queryRadius(Vector2D pos, float radius) {
+        uint32_t epoch = spatial_hash.epoch();
+        if (auto cached = query_cache.tryGet(pos, radius, epoch)) {
+            return *cached;
         }
         
-        // Filter results by actual distance
-        result.erase(
-            std::remove_if(result.begin(), result.end(),
-                [&](const ParticleRef& p) {
-                    Vector2D p_pos(p.getX(), p.getY());
-                    return !DistanceCalculator::isWithinRadius(pos, p_pos, radiusSquared);
-                }
-            ),
-            result.end()
-        );
+        std::vector<ParticleRef> result;
+        forEachInRadius(pos, radius, [&](const ParticleRef& p) { result.push_back(p); });
         
-        query_cache.store(pos, radius, result, getCurrentTimestamp());
+        query_cache.store(pos, radius, result, getCurrentTimestamp(), epoch);
         return result;
     }
     
     template<typename FilterFunc>
     std::vector<ParticleRef> queryRadiusFiltered(Vector2D pos, float radius, FilterFunc filter) {
-        auto results = queryRadius(pos, radius);
         std::vector<ParticleRef> filtered;
-        filtered.reserve(results.size());
-        
-        std::copy_if(results.begin(), results.end(), 
-                     std::back_inserter(filtered), filter);
+        forEachInRadius(pos, radius, [&](const ParticleRef& p) {
+            if (filter(p)) {
+                filtered.push_back(p);
+            }
+        });
         return filtered;
     }
     
     std::vector<ParticleRef> queryBox(Vector2D min, Vector2D max) {
         std::vector<ParticleRef> result;
-        int start_x = static_cast<int>(min.x / SpatialHash::CELL_SIZE);
-        int start_y = static_cast<int>(min.y / SpatialHash::CELL_SIZE);
-        int end_x = static_cast<int>(max.x / SpatialHash::CELL_SIZE);
-        int end_y = static_cast<int>(max.y / SpatialHash::CELL_SIZE);
-        
-        for(int y = start_y; y <= end_y; y++) {
-            for(int x = start_x; x <= end_x; x++) {
-                queryCell(x, y, result);
-            }
-        }
+        forEachInBox(min, max, [&](const ParticleRef& p) { result.push_back(p); });
         return result;
     }
     
     std::vector<ParticleRef> queryKNearest(Vector2D pos, size_t k) {
         std::vector<ParticleRef> result;
-        float search_radius = SpatialHash::CELL_SIZE;
+        float search_radius = static_cast<float>(spatial_hash.getCellSize());
+        float max_radius = static_cast<float>(std::max(spatial_hash.getWidth(), spatial_hash.getHeight()));
         
+        // Stops once the radius spans the hash, with fewer than k particles
         while(result.size() < k) {
             result = queryRadius(pos, search_radius);
+            if(search_radius >= max_radius) {
+                break;
+            }
             search_radius *= 2.0f;
         }
         
@@ -327,14 +348,19 @@ public:
         }
         return result;
     }
+    /** @brief Particles of every cell whose 3x3 neighbourhood holds at least min_density */
     std::vector<ParticleRef> queryDenseRegions(float min_density) {
         std::vector<ParticleRef> result;
-        auto dense_regions = spatial_index.getDenseRegions();
+        spatial_index.rebuild(spatial_hash);
         
-        // Use min_density as threshold for density filtering
-        for(const auto& region : dense_regions) {
-            if(spatial_index.density_map[region.y * spatial_index.grid_width + region.x] >= min_density) {
-                queryCell(region.x, region.y, result);
+        for(uint32_t y = 0; y < spatial_index.grid_height; y++) {
+            for(uint32_t x = 0; x < spatial_index.grid_width; x++) {
+                uint32_t index = y * spatial_index.grid_width + x;
+                if(spatial_index.cell_occupancy[index] > 0 &&
+                   spatial_index.density_map[index] >= min_density) {
+                    spatial_hash.forEachInCell(x * spatial_hash.getCellSize(), y * spatial_hash.getCellSize(),
+                        [&](const ParticleRef& p) { result.push_back(p); });
+                }
             }
         }
         return result;
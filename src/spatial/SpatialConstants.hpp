@@ -3,4 +3,24 @@
 
 namespace spatial {
     static const uint32_t CELL_SIZE = 8;
+
+    /** @brief Packs cell coordinates into one 64-bit key */
+    inline uint64_t cellKey(uint32_t cx, uint32_t cy) {
+        return (static_cast<uint64_t>(cx) << 32) | cy;
+    }
+
+    /**
+     * @brief Full-avalanche 64-bit mix (splitmix64 finaliser)
+     * @note Every input bit affects the low bits, so neighbouring cells and
+     *       whole rows of cells spread over a table instead of sharing the
+     *       low bits of y
+     */
+    inline uint64_t mixKey(uint64_t key) {
+        key ^= key >> 30;
+        key *= 0xbf58476d1ce4e5b9ULL;
+        key ^= key >> 27;
+        key *= 0x94d049bb133111ebULL;
+        key ^= key >> 31;
+        return key;
+    }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../particle/ParticleRef.hpp"
+#include "../grid/Grid.hpp"
 #include <cstdint>
 #include <vector>
 #include <array>
@@ -8,7 +9,13 @@
 #include <algorithm>
 #include <mutex>
 #include <cmath>
+#include <stdexcept>
+#include <functional>
+#include <string>
 #include "SpatialConstants.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 /**
  * @brief High-performance spatial partitioning system with thread-safe operations
  * 
@@ -23,7 +30,7 @@
  * - Cache hit rate: ~89%
  * 
  * Key Features:
- * - Dynamic bucket resizing
+ * - Incremental bucket growth (linear hashing)
  * - Thread-safe operations
  * - Query result caching
  * - Parallel batch updates
@@ -31,8 +38,9 @@
  * 
  * Usage Examples:
  * @code
- * // Initialize hash
- * SpatialHash hash;
+ * // Initialize hash over a grid, default or chosen cell size
+ * SpatialHash hash(grid);
+ * SpatialHash coarse(grid, 32);
  * 
  * // Insert particle
  * ParticleRef ref(&grid, x, y);
@@ -41,6 +49,10 @@
  * // Spatial query
  * auto particles = hash.query(x, y);
  * 
+ * // Zero-copy access while no writer runs
+ * hash.forEachInCell(x, y, [&](const ParticleRef& p) { ... });
+ * SpatialHash::CellView view = hash.viewCell(x, y);  // Until hash.epoch() changes
+ * 
  * // Batch update with parallel processing
  * std::vector<ParticleRef> updates;
  * hash.batchUpdate(updates);
@@ -50,45 +62,69 @@
  * 
  * 1. Particle Management:
  *    - insert(): Add particle to spatial hash
- *    - remove(): Remove particle from hash
- *    - query(): Get particles in cell
+ *    - remove(): Remove particle from hash, O(1) through the slot table
+ *    - relocate(): Re-index a moved particle; in place within a bucket
+ *    - query(): Get particles in cell (copy, cached)
+ *    - forEachInCell(), viewCell(): Zero-copy access to one cell's
+ *      contiguous particles under a read epoch; forEachParticle() visits
+ *      every entry
  * 
  * 2. Batch Operations:
  *    - batchUpdate(): Parallel particle updates
- *    - parallelUpdate(): Large batch processing
+ *    - applyChanges(): Removals and insertions grouped by bucket
+ *    - parallelUpdate(): Large batches, binned per thread and merged per
+ *      shard of buckets without locks
  *    - sequentialUpdate(): Small batch processing
  * 
  * 3. Hash Properties:
  *    - getWidth(): Hash grid width
  *    - getHeight(): Hash grid height
+ *    - getCellSize(): Cell edge, fixed per hash
  *    - hashPos(): Calculate spatial hash
+ *    - size(): Indexed particles
  * 
  * Memory Layout:
- * - Buckets: Vector of particle vectors
+ * - Buckets: Particle vectors in chunks of 4096, with their mutexes;
+ *   chunks are allocated as buckets split and never move. Each cell's
+ *   entries form one contiguous run within its bucket.
+ * - Chunk directory: One pointer per allocated chunk, doubled as chunks
+ *   are added; replaced directories are kept until destruction, since
+ *   readers index it without locks
+ * - Slot table: uint32 per cell of the indexed grid, each particle's
+ *   position within its bucket
  * - Cache: Fixed-size query cache (64 entries)
- * - Mutexes: One per bucket for thread safety
+ * - Mutexes: One per bucket for thread safety, stored with the bucket
  * 
  * Performance Characteristics:
- * - Insert/Remove: O(1) amortized
+ * - Insert/Remove/Relocate: O(1) amortized, no bucket scans, unless
+ *   cells collide in a bucket; then the later runs shift by one entry each
+ * - Growth: at most 2 bucket splits per insert, so no insert pays for a
+ *   full rehash; batches split the buckets they need up front
  * - Query: O(1) + particles in cell
+ * - Batch insert: O(n / threads), one reservation per touched bucket
  * - Memory: O(n) where n is particle count
  * - Cache: O(1) lookup time
  * 
  * Implementation Details:
- * - Cell size: 32x32 units
+ * - Cell size: 8x8 units by default; any power of two per hash
+ * - World bounds: from the grid (2048x2048 by default); they bound area
+ *   queries, not the keys, so nothing piles up in edge cells
  * - Initial buckets: 256 (power of 2)
- * - Load factor threshold: 0.75
+ * - Load factor threshold: 0.75, kept by splitting the bucket at the
+ *   split pointer; a level ends once every bucket of it has split
  * - Cache size: 64 entries
  * - Parallel threshold: 1000 particles
  * 
  * Thread Safety:
  * - Fine-grained bucket locking
  * - Lock-free query cache
+ * - Zero-copy reads take no locks: any number of readers, no writers
  * - Atomic particle count
- * - Thread-safe resizing
+ * - Thread-safe resizing: a split holds only the two buckets it touches,
+ *   and writers re-check their bucket after locking it
  * 
  * Optimization Features:
- * - Power-of-two bucket counts
+ * - Power-of-two address masks
  * - Pre-allocated bucket storage
  * - SIMD-friendly hash calculation
  * - Adaptive parallel processing
@@ -97,9 +133,12 @@
  * @see ParticleRef, Vector2D
  */class SpatialHash {
 public:
-    /** @brief Spatial cell size for partitioning */
+    /** @brief Default spatial cell size for partitioning; see getCellSize() */
     static const uint32_t CELL_SIZE = spatial::CELL_SIZE;
 
+    /** @brief World extent of a default-constructed hash */
+    static const uint32_t DEFAULT_WORLD_SIZE = 2048;
+
 private:
     /** @brief Initial number of hash buckets (power of 2 for efficient modulo) */
     static const uint32_t INITIAL_BUCKETS = 256;
@@ -113,6 +152,20 @@ private:
     /** @brief Threshold for parallel processing */
     static const size_t PARALLEL_THRESHOLD = 1000;
 
+    /** @brief Bucket ranges a batch insertion is merged in (power of 2) */
+    static constexpr size_t INSERT_SHARDS = 256;
+
+    /** @brief Buckets per storage chunk; chunks never move once allocated */
+    static constexpr size_t CHUNK_BUCKETS = 4096;
+
+    /** @brief Bucket limit */
+    static constexpr size_t MAX_BUCKETS = size_t(1) << 28;
+
+    /** @brief Buckets split per insert while the load factor is exceeded */
+    static const int SPLITS_PER_INSERT = 2;
+
+    static_assert(INITIAL_BUCKETS <= CHUNK_BUCKETS, "Initial buckets must fit the first chunk");
+
     /** @brief Load factor threshold for bucket resizing */
     float load_factor_threshold = 0.75f;
 
@@ -125,20 +178,58 @@ private:
 
     /** @brief Cache entry for spatial queries */
     struct QueryCache {
-        uint64_t hash_key;
+        uint64_t hash_key = 0;
         std::vector<ParticleRef> results;
-        uint32_t timestamp;
+        uint32_t timestamp = 0;
+        bool valid = false;
+    };
+
+    /** @brief Slot table value of a particle that is not indexed */
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    /** @brief CHUNK_BUCKETS buckets and their mutexes */
+    struct BucketChunk {
+        std::array<std::vector<ParticleRef>, CHUNK_BUCKETS> buckets;
+        std::array<std::mutex, CHUNK_BUCKETS> mutexes;
     };
 
-    std::vector<std::vector<ParticleRef>> buckets;
-    std::unique_ptr<std::mutex[]> bucket_mutexes;
+    /** @brief Chunk pointers read by bucketAt(), grown by addChunk() */
+    std::atomic<BucketChunk* const*> chunk_directory{nullptr};
+    size_t directory_capacity = 0;
+    std::vector<std::unique_ptr<BucketChunk>> chunks;  ///< Owns the chunks, in bucket order
+    std::vector<std::unique_ptr<BucketChunk*[]>> directories;  ///< Current and replaced
+
+    /** @brief Linear hashing state: level << 32 | split pointer */
+    std::atomic<uint64_t> addressing{0};
     std::array<QueryCache, CACHE_SIZE> query_cache;
     std::mutex resize_mutex;
     std::atomic<bool> is_resizing{false};
-    uint32_t current_timestamp;
-    size_t particle_count;
+    std::atomic<uint32_t> current_timestamp;
+    std::atomic<size_t> particle_count;
     uint32_t width;
     uint32_t height;
+    uint32_t cell_size;
+    uint32_t cell_shift;  ///< log2(cell_size)
+
+    /**
+     * @brief Position of every indexed particle within its bucket
+     * @note One entry per cell of the indexed grid (y * width + x). A
+     *       particle's entry is only written under its bucket, so buckets
+     *       never contend for it.
+     */
+    std::vector<uint32_t> slots;
+    std::atomic<const Grid*> slot_grid{nullptr};
+    uint32_t slot_width = 0;
+
+    /** @brief A change bound for one bucket; scratch for applyChanges() */
+    struct BucketChange {
+        size_t bucket;
+        ParticleRef ref;
+        bool insert;
+    };
+    std::vector<BucketChange> pending_changes;
+    std::vector<std::vector<BucketChange>> shard_bins;  ///< Per thread, per shard
+    std::vector<size_t> change_runs;
 
     /** @brief Statistics for load balancing */
     struct BucketStats {
@@ -147,6 +238,289 @@ private:
         size_t max_size;
     };
 
+    /**
+     * @brief Bucket of a cell key under linear hashing
+     * @note The key is mixed, so rows of cells spread over all buckets.
+     *       Buckets below the split pointer have been split this level and
+     *       are addressed with one more bit.
+     */
+    size_t bucketIndex(uint64_t hash) const {
+        uint64_t state = addressing.load(std::memory_order_acquire);
+        size_t low = static_cast<size_t>(INITIAL_BUCKETS) << (state >> 32);
+        uint64_t mixed = spatial::mixKey(hash);
+        size_t index = mixed & (low - 1);
+        if(index < (state & UINT32_MAX)) {
+            index = mixed & (2 * low - 1);
+        }
+        return index;
+    }
+
+    /** @brief Buckets in use: 2^level * INITIAL_BUCKETS plus the split ones */
+    size_t bucketCount() const {
+        uint64_t state = addressing.load(std::memory_order_acquire);
+        return (static_cast<size_t>(INITIAL_BUCKETS) << (state >> 32)) + (state & UINT32_MAX);
+    }
+
+    BucketChunk& chunkAt(size_t index) const {
+        return *chunk_directory.load(std::memory_order_acquire)[index / CHUNK_BUCKETS];
+    }
+
+    std::vector<ParticleRef>& bucketAt(size_t index) {
+        return chunkAt(index).buckets[index % CHUNK_BUCKETS];
+    }
+
+    const std::vector<ParticleRef>& bucketAt(size_t index) const {
+        return chunkAt(index).buckets[index % CHUNK_BUCKETS];
+    }
+
+    std::mutex& mutexAt(size_t index) const {
+        return chunkAt(index).mutexes[index % CHUNK_BUCKETS];
+    }
+
+    /**
+     * @brief Allocates the next chunk, doubling the directory when it is full
+     * @note Caller holds resize_mutex, or is the constructor. A larger
+     *       directory is published before any of its new buckets is, and
+     *       the old one stays valid for readers that loaded it.
+     */
+    void addChunk() {
+        size_t count = chunks.size();
+        if(count == directory_capacity) {
+            size_t capacity = std::max<size_t>(1, directory_capacity * 2);
+            auto directory = std::make_unique<BucketChunk*[]>(capacity);
+            for(size_t i = 0; i < count; ++i) {
+                directory[i] = chunks[i].get();
+            }
+            chunk_directory.store(directory.get(), std::memory_order_release);
+            directories.push_back(std::move(directory));
+            directory_capacity = capacity;
+        }
+        chunks.push_back(std::make_unique<BucketChunk>());
+        // Readers reach this entry only through a split published after it
+        directories.back()[count] = chunks.back().get();
+    }
+
+    /**
+     * @brief Locks the bucket of a cell key
+     * @return The locked bucket; re-checked after locking, since a split
+     *         may have moved the key meanwhile
+     */
+    size_t lockBucket(uint64_t hash, std::unique_lock<std::mutex>& lock) const {
+        while(true) {
+            size_t index = bucketIndex(hash);
+            lock = std::unique_lock<std::mutex>(mutexAt(index));
+            if(bucketIndex(hash) == index) {
+                return index;
+            }
+            lock.unlock();
+        }
+    }
+
+    float loadFactor() const {
+        return static_cast<float>(particle_count) / bucketCount();
+    }
+
+    /** @brief Slot table entry of a particle of the bound grid */
+    size_t slotIndex(const ParticleRef& p) const {
+        return static_cast<size_t>(p.getY()) * slot_width + p.getX();
+    }
+
+    /**
+     * @brief Binds the slot table to p's grid on first use
+     * @throws std::invalid_argument if p belongs to no grid or another grid
+     * @throws std::out_of_range if p lies outside its grid
+     */
+    void bindGrid(const ParticleRef& p) {
+        const Grid* grid = p.getGrid();
+        if(grid != slot_grid.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(resize_mutex);
+            if(grid == nullptr || (slot_grid.load() != nullptr && slot_grid.load() != grid)) {
+                throw std::invalid_argument("SpatialHash indexes the particles of a single grid");
+            }
+            if(slot_grid.load() == nullptr) {
+                slot_width = grid->getWidth();
+                slots.assign(static_cast<size_t>(grid->getWidth()) * grid->getHeight(), NO_SLOT);
+                slot_grid.store(grid, std::memory_order_release);
+            }
+        }
+        if(!p.isValid()) {
+            throw std::out_of_range("ParticleRef outside its grid");
+        }
+    }
+
+    /**
+     * @brief Rejects a position other than p's own
+     * @throws std::invalid_argument if (x, y) is not p's position; entries
+     *         are kept in runs and rehomed on splits by their own position
+     */
+    static void checkPosition(const ParticleRef& p, uint32_t x, uint32_t y) {
+        if(p.getX() != x || p.getY() != y) {
+            throw std::invalid_argument("SpatialHash indexes a particle at its own position, got (" +
+                                        std::to_string(x) + ", " + std::to_string(y) + ") for (" +
+                                        std::to_string(p.getX()) + ", " + std::to_string(p.getY()) + ")");
+        }
+    }
+
+    /** @brief True if p is a particle of the bound grid and currently indexed */
+    bool isIndexed(const ParticleRef& p) const {
+        return p.getGrid() != nullptr && p.getGrid() == slot_grid.load(std::memory_order_acquire) &&
+               p.isValid() && slots[slotIndex(p)] != NO_SLOT;
+    }
+
+    /** @brief Cell key of an indexed particle */
+    uint64_t keyOf(const ParticleRef& p) const {
+        return hashPos(p.getX(), p.getY());
+    }
+
+    /** @brief Moves a bucket entry to another slot and records it */
+    void moveEntry(std::vector<ParticleRef>& bucket, size_t from, size_t to) {
+        bucket[to] = bucket[from];
+        slots[slotIndex(bucket[to])] = static_cast<uint32_t>(to);
+    }
+
+    /**
+     * @brief Adds p at the end of its cell's run; caller holds the bucket,
+     *        p is not indexed
+     * @note O(1) when the cell's run is the bucket's last, which it is
+     *       unless cells collide; see insertIntoRun()
+     */
+    void pushToBucket(size_t index, const ParticleRef& p) {
+        auto& bucket = bucketAt(index);
+        size_t slot = bucket.size();
+        bucket.push_back(p);
+        if(slot != 0 && keyOf(bucket[slot - 1]) != keyOf(bucket[slot])) {
+            slot = insertIntoRun(bucket);
+        }
+        slots[slotIndex(bucket[slot])] = static_cast<uint32_t>(slot);
+    }
+
+    /**
+     * @brief Moves a bucket's last entry to the end of its cell's run
+     * @return The entry's new slot
+     * @note Each later run shifts by one, its first entry moving to its end
+     */
+    size_t insertIntoRun(std::vector<ParticleRef>& bucket) {
+        size_t hole = bucket.size() - 1;
+        ParticleRef entry = bucket[hole];
+        uint64_t key = keyOf(entry);
+        size_t run_end = 0;
+        for(size_t i = 0; i < hole; ++i) {
+            if(keyOf(bucket[i]) == key) {
+                run_end = i + 1;
+            }
+        }
+        if(run_end == 0) {
+            return hole;  // A new cell; its run starts at the end
+        }
+        
+        // Walk the later runs back to front, moving each run's first entry
+        // into the hole after it
+        size_t i = hole;
+        while(i > run_end) {
+            uint64_t run_key = keyOf(bucket[i - 1]);
+            size_t first = i - 1;
+            while(first > run_end && keyOf(bucket[first - 1]) == run_key) {
+                first--;
+            }
+            moveEntry(bucket, first, hole);
+            hole = first;
+            i = first;
+        }
+        bucket[hole] = entry;
+        return hole;
+    }
+
+    /**
+     * @brief Removes the entry at slot, keeping every cell's run contiguous
+     * @note The caller clears the removed particle's slot. O(1) when its
+     *       run is the bucket's last; otherwise each later run shifts back
+     *       by one, its last entry moving into the hole ahead of it.
+     */
+    void closeSlot(std::vector<ParticleRef>& bucket, size_t slot) {
+        uint64_t run_key = keyOf(bucket[slot]);
+        if(keyOf(bucket.back()) == run_key) {
+            if(slot + 1 != bucket.size()) {
+                moveEntry(bucket, bucket.size() - 1, slot);
+            }
+            bucket.pop_back();
+            return;
+        }
+        
+        size_t hole = slot;
+        size_t last = slot;
+        while(true) {
+            while(last + 1 < bucket.size() && keyOf(bucket[last + 1]) == run_key) {
+                last++;
+            }
+            if(last != hole) {
+                moveEntry(bucket, last, hole);
+            }
+            hole = last;
+            if(last + 1 == bucket.size()) {
+                break;
+            }
+            run_key = keyOf(bucket[++last]);
+        }
+        bucket.pop_back();
+    }
+
+    /**
+     * @brief Removes p from a bucket through its slot; caller holds the bucket
+     * @return false if p is not in that bucket
+     */
+    bool popFromBucket(size_t index, const ParticleRef& p) {
+        if(!isIndexed(p)) {
+            return false;
+        }
+        auto& bucket = bucketAt(index);
+        uint32_t& slot = slots[slotIndex(p)];
+        if(slot >= bucket.size() || !(bucket[slot] == p)) {
+            return false;
+        }
+        size_t removed = slot;
+        slot = NO_SLOT;
+        closeSlot(bucket, removed);
+        return true;
+    }
+
+    /**
+     * @brief Puts to into from's place; caller holds the bucket of both
+     * @note In place within a cell; a move to a colliding cell re-enters
+     *       the bucket at the end of to's run
+     */
+    bool replaceInBucket(size_t index, const ParticleRef& from, const ParticleRef& to) {
+        if(!isIndexed(from) || isIndexed(to)) {
+            return false;
+        }
+        auto& bucket = bucketAt(index);
+        uint32_t slot = slots[slotIndex(from)];
+        if(slot >= bucket.size() || !(bucket[slot] == from)) {
+            return false;
+        }
+        slots[slotIndex(from)] = NO_SLOT;
+        if(keyOf(from) == keyOf(to)) {
+            bucket[slot] = to;
+            slots[slotIndex(to)] = slot;
+        } else {
+            closeSlot(bucket, slot);
+            pushToBucket(index, to);
+        }
+        return true;
+    }
+
+    /** @brief Bounds [first, last) of a cell's run within its bucket */
+    std::pair<size_t, size_t> cellRun(const std::vector<ParticleRef>& bucket, uint64_t key) const {
+        size_t first = 0;
+        while(first < bucket.size() && keyOf(bucket[first]) != key) {
+            first++;
+        }
+        size_t last = first;
+        while(last < bucket.size() && keyOf(bucket[last]) == key) {
+            last++;
+        }
+        return {first, last};
+    }
+
     /** @brief Checks if number is power of two */
     bool isPowerOfTwo(size_t x) {
         return (x & (x - 1)) == 0;
@@ -167,12 +541,7 @@ private:
 
     /** @brief Pre-allocates buckets for expected particle count */
     void preallocateBuckets(size_t expected_particles) {
-        size_t bucket_count = nextPowerOfTwo(expected_particles / CELL_SIZE);
-        buckets.resize(bucket_count);
-        bucket_mutexes = std::make_unique<std::mutex[]>(bucket_count);
-        for(auto& bucket : buckets) {
-            bucket.reserve(BUCKET_RESERVE_SIZE);
-        }
+        resizeBuckets(static_cast<size_t>(expected_particles / load_factor_threshold));
     }
 
     /** @brief Gets cached query results or computes new ones */
@@ -180,11 +549,12 @@ private:
         size_t cache_index = hash & (CACHE_SIZE - 1);
         auto& cache_entry = query_cache[cache_index];
         
-        if(cache_entry.hash_key == hash && 
+        if(cache_entry.valid && cache_entry.hash_key == hash && 
            cache_entry.timestamp == current_timestamp) {
             return cache_entry.results;
         }
         
+        cache_entry.valid = true;
         cache_entry.hash_key = hash;
         cache_entry.timestamp = current_timestamp;
         cache_entry.results = computeQueryResults(hash);
@@ -193,17 +563,21 @@ private:
 
     /** @brief Computes query results for given hash */
     std::vector<ParticleRef> computeQueryResults(uint64_t hash) {
-        size_t index = hash & (buckets.size() - 1);
-        std::lock_guard<std::mutex> lock(bucket_mutexes[index]);
-        return buckets[index];
+        std::unique_lock<std::mutex> lock;
+        size_t index = lockBucket(hash, lock);
+        return bucketAt(index);
     }
 
-    /** @brief Checks if resize is needed based on load factor */
+    /** @brief Splits up to SPLITS_PER_INSERT buckets while the load factor is exceeded */
     void checkResize() {
-        float load_factor = static_cast<float>(particle_count) / buckets.size();
-        if(load_factor > load_factor_threshold && !is_resizing.exchange(true)) {
+        if(loadFactor() > load_factor_threshold && !is_resizing.exchange(true)) {
             try {
-                resizeBuckets();
+                std::lock_guard<std::mutex> resize_lock(resize_mutex);
+                for(int i = 0; i < SPLITS_PER_INSERT && loadFactor() > load_factor_threshold; ++i) {
+                    if(!splitBucket()) {
+                        break;
+                    }
+                }
             } catch(...) {
                 is_resizing.store(false);
                 throw;
@@ -212,156 +586,272 @@ private:
         }
     }
     
-    /** @brief Resizes bucket array with rehashing */
-    // Codi AI helped me a lot to debug this function
-    void resizeBuckets() {
-        // Lock the resize mutex for the entire operation
+    /**
+     * @brief Splits buckets until at least min_size are in use
+     * @note For batches, whose bucket indices are computed up front
+     */
+    void resizeBuckets(size_t min_size) {
         std::lock_guard<std::mutex> resize_lock(resize_mutex);
-        
-        // Create new buckets and mutexes
-        size_t new_size = nextPowerOfTwo(buckets.size() * 2);
-        std::vector<std::vector<ParticleRef>> new_buckets(new_size);
-        auto new_mutexes = std::make_unique<std::mutex[]>(new_size);
-        
-        // Reserve space in each new bucket
-        for(auto& bucket : new_buckets) {
-            bucket.reserve(BUCKET_RESERVE_SIZE);
+        while(bucketCount() < min_size && splitBucket()) {
         }
-        
-        // Process each bucket individually to minimize lock contention
-        for(size_t i = 0; i < buckets.size(); ++i) {
-            std::vector<ParticleRef> bucket_copy;
-            
-            {
-                // Lock only the current bucket
-                std::lock_guard<std::mutex> bucket_lock(bucket_mutexes[i]);
-                bucket_copy = buckets[i]; // Make a copy while holding the lock
-            }
-            
-            // Process the copy without holding the lock
-            for(const auto& particle : bucket_copy) {
-                try {
-                    uint32_t x = particle.getX();
-                    uint32_t y = particle.getY();
-                    
-                    // Validate coordinates
-                    if(x < width && y < height) {
-                        uint64_t hash = hashPos(x, y);
-                        size_t new_index = hash & (new_size - 1);
-                        
-                        // We need to lock the destination bucket in the new array
-                        {
-                            std::lock_guard<std::mutex> new_bucket_lock(new_mutexes[new_index]);
-                            new_buckets[new_index].push_back(particle);
-                        }
-                    }
-                } catch(const std::exception& e) {
-                    // Skip invalid particles
-                    continue;
-                }
-            }
+    }
+
+    /**
+     * @brief One linear hashing step: moves the entries of the bucket at the
+     *        split pointer that now address its new sibling
+     * @return false once MAX_BUCKETS are in use
+     * @note Caller holds resize_mutex. Costs one bucket's entries, plus one
+     *       chunk allocation every CHUNK_BUCKETS splits; no other bucket
+     *       moves, so no insert ever waits for a full rehash.
+     */
+    bool splitBucket() {
+        uint64_t state = addressing.load(std::memory_order_relaxed);
+        size_t low = static_cast<size_t>(INITIAL_BUCKETS) << (state >> 32);
+        size_t split = state & UINT32_MAX;
+        size_t sibling = low + split;
+        if(sibling >= MAX_BUCKETS) {
+            return false;
         }
-        
-        // Now swap the buckets and mutexes atomically            
-        for(size_t i = 0; i < buckets.size(); ++i) {
-            bucket_mutexes[i].lock();
-        }
-
-        try {
-            // Store old data in temporary variables
-            auto old_buckets = std::move(buckets);
-            auto old_mutexes = std::move(bucket_mutexes);
-            
-            // Swap buckets and mutexes
-            buckets = std::move(new_buckets);
-            bucket_mutexes = std::move(new_mutexes);
-
-            //Unlock all old mutexes
-            for(size_t i = 0; i < old_buckets.size(); ++i) {
-                old_mutexes[i].unlock();
-            }
+        if(sibling / CHUNK_BUCKETS == chunks.size()) {
+            addChunk();
         }
-        catch(...) {
-            // If an exception occurs, unlock all mutexes
-            for(size_t i = 0; i < buckets.size(); ++i) {
-                bucket_mutexes[i].unlock();
+        
+        std::lock_guard<std::mutex> from_lock(mutexAt(split));
+        std::lock_guard<std::mutex> to_lock(mutexAt(sibling));
+        auto& from = bucketAt(split);
+        auto& to = bucketAt(sibling);
+        size_t kept = 0;
+        // A stable partition: whole cells move, in order, so runs stay contiguous
+        for(size_t i = 0; i < from.size(); ++i) {
+            ParticleRef particle = from[i];
+            uint64_t hash = hashPos(particle.getX(), particle.getY());
+            if((spatial::mixKey(hash) & (2 * low - 1)) == sibling) {
+                slots[slotIndex(particle)] = static_cast<uint32_t>(to.size());
+                to.push_back(particle);
+            } else {
+                slots[slotIndex(particle)] = static_cast<uint32_t>(kept);
+                from[kept++] = particle;
             }
-            throw; // Rethrow the exception
         }
-        // Update timestamp to invalidate queries
-        current_timestamp++;
+        from.erase(from.begin() + kept, from.end());
+        
+        // Published while both buckets are held; writers that looked up the
+        // old bucket re-check after locking it
+        uint64_t next = split + 1 == low ? ((state >> 32) + 1) << 32 : state + 1;
+        addressing.store(next, std::memory_order_release);
+        current_timestamp++;  // Views of the split bucket are stale
+        return true;
     }
 
 public:
-    SpatialHash() 
-        : buckets(INITIAL_BUCKETS)
-        , bucket_mutexes(std::make_unique<std::mutex[]>(INITIAL_BUCKETS))
-        , current_timestamp(0)
+    /** @brief Hash over a DEFAULT_WORLD_SIZE square world with the default cell size */
+    SpatialHash()
+        : SpatialHash(DEFAULT_WORLD_SIZE, DEFAULT_WORLD_SIZE)
+    {}
+
+    /**
+     * @param w World width, the extent area queries cover
+     * @param h World height
+     * @param cellSize Spatial cell edge in grid cells
+     * @throws std::invalid_argument if cellSize is not a power of two
+     */
+    SpatialHash(uint32_t w, uint32_t h, uint32_t cellSize = CELL_SIZE)
+        : current_timestamp(0)
         , particle_count(0)
-        , width(INITIAL_BUCKETS * CELL_SIZE)
-        , height(INITIAL_BUCKETS * CELL_SIZE)
+        , width(w)
+        , height(h)
+        , cell_size(cellSize)
+        , cell_shift(0)
     {
-        for(auto& bucket : buckets) {
-            bucket.reserve(BUCKET_RESERVE_SIZE);
+        if(cellSize == 0 || (cellSize & (cellSize - 1))) {
+            throw std::invalid_argument("SpatialHash cell size must be a power of two, got " +
+                                        std::to_string(cellSize));
+        }
+        while((1u << cell_shift) < cellSize) {
+            cell_shift++;
+        }
+        addChunk();
+        for(size_t i = 0; i < INITIAL_BUCKETS; ++i) {
+            bucketAt(i).reserve(BUCKET_RESERVE_SIZE);
         }
     }
 
+    /** @brief Hash sized from a grid's dimensions, for any storage policy */
+    template<typename Storage>
+    explicit SpatialHash(const BasicGrid<Storage>& grid, uint32_t cellSize = CELL_SIZE)
+        : SpatialHash(grid.getWidth(), grid.getHeight(), cellSize)
+    {}
+
     /** @brief Gets grid width */
     uint32_t getWidth() const { return width; }
     
     /** @brief Gets grid height */
     uint32_t getHeight() const { return height; }
+
+    /** @brief Spatial cell edge in grid cells */
+    uint32_t getCellSize() const { return cell_size; }
     
-    /** @brief Calculates spatial hash for coordinates */
+    /**
+     * @brief Calculates spatial hash for coordinates
+     * @note Not clamped: positions outside the world get cells of their own
+     */
     uint64_t hashPos(uint32_t x, uint32_t y) const {
-        x = std::min(x, width - 1);
-        y = std::min(y, height - 1);
-        return (static_cast<uint64_t>(x/CELL_SIZE) << 32) 
-               | static_cast<uint64_t>(y/CELL_SIZE);
+        return spatial::cellKey(x >> cell_shift, y >> cell_shift);
     }
     
-    /** @brief Thread-safe particle insertion */
+    /**
+     * @brief Thread-safe particle insertion
+     * @param x, y p's position
+     * @note A particle that is already indexed is left where it is
+     * @throws std::invalid_argument if (x, y) is not p's position, or p
+     *         belongs to no grid or to another grid than the particles
+     *         indexed so far
+     */
     void insert(ParticleRef p, uint32_t x, uint32_t y) {
+        checkPosition(p, x, y);
+        bindGrid(p);
         uint64_t hash = hashPos(x, y);
-        size_t index = hash & (buckets.size() - 1);
         
         {
-            std::lock_guard<std::mutex> lock(bucket_mutexes[index]);
-            buckets[index].push_back(p);
+            std::unique_lock<std::mutex> lock;
+            size_t index = lockBucket(hash, lock);
+            if(slots[slotIndex(p)] != NO_SLOT) {
+                return;
+            }
+            pushToBucket(index, p);
             particle_count++;
+            current_timestamp++;
         }
         checkResize();
     }
     
-    /** @brief Thread-safe particle removal */
-    void remove(ParticleRef p, uint32_t x, uint32_t y) {
-        // Validate coordinates
-        if (x >= width || y >= height) {
-            return;  // Out of bounds, just return
+    /**
+     * @brief Thread-safe particle removal; O(1) through the slot table
+     * @return false if p was not indexed
+     * @throws std::invalid_argument if (x, y) is not p's position
+     */
+    bool remove(ParticleRef p, uint32_t x, uint32_t y) {
+        checkPosition(p, x, y);
+        std::unique_lock<std::mutex> lock;
+        size_t index = lockBucket(hashPos(x, y), lock);
+        if(!popFromBucket(index, p)) {
+            return false;
         }
+        particle_count--;
+        current_timestamp++;
+        return true;
+    }
 
-        uint64_t hash = hashPos(x, y);
-        size_t index = hash & (buckets.size() - 1);
-        
+    /**
+     * @brief Re-indexes a particle that moved; both refs at their own positions
+     * @return false if from was not indexed or to already is
+     * @note A move within one bucket (always the case within a cell)
+     *       rewrites the entry in place and leaves the bucket as it is
+     */
+    bool relocate(const ParticleRef& from, const ParticleRef& to) {
+        bindGrid(to);
+        if(isIndexed(to)) {
+            return false;
+        }
         {
-            std::lock_guard<std::mutex> lock(bucket_mutexes[index]);
-            auto& bucket = buckets[index];
-
-            if (bucket.empty()) {
-                return;  // Bucket is empty, nothing to remove
+            // While from's bucket is held it cannot split, so a to that
+            // addresses it now stays there
+            std::unique_lock<std::mutex> lock;
+            size_t from_index = lockBucket(hashPos(from.getX(), from.getY()), lock);
+            if(bucketIndex(hashPos(to.getX(), to.getY())) == from_index) {
+                bool moved = replaceInBucket(from_index, from, to);
+                current_timestamp += moved;
+                return moved;
             }
-
-            bucket.erase(std::remove(bucket.begin(), bucket.end(), p), bucket.end());
-            particle_count--;
         }
+        if(!remove(from, from.getX(), from.getY())) {
+            return false;
+        }
+        insert(to, to.getX(), to.getY());
+        return true;
     }
     
-    /** @brief Thread-safe spatial query with caching */
+    /**
+     * @brief Thread-safe spatial query with caching
+     * @note Copies the bucket, particles of colliding cells included; see
+     *       forEachInCell() and viewCell() for the non-allocating forms
+     */
     std::vector<ParticleRef> query(uint32_t x, uint32_t y) {
         return getCachedQuery(hashPos(x, y));  ///< Returns vector of particleRef instead of uint64_t
     }
+
+    /**
+     * @brief Read-only view of one cell's contiguous particles
+     * @note Valid while the hash's epoch() equals the view's, i.e. until the
+     *       next write
+     */
+    class CellView {
+    public:
+        const ParticleRef* begin() const { return first; }
+        const ParticleRef* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+        const ParticleRef& operator[](size_t i) const { return first[i]; }
+        uint32_t epoch() const { return read_epoch; }
+
+    private:
+        friend class SpatialHash;
+        CellView(const ParticleRef* begin, const ParticleRef* end, uint32_t e)
+            : first(begin), last(end), read_epoch(e) {}
+
+        const ParticleRef* first;
+        const ParticleRef* last;
+        uint32_t read_epoch;
+    };
+
+    /** @brief Write counter; views and cached results taken at another epoch are stale */
+    uint32_t epoch() const { return current_timestamp.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Zero-copy view of the particles of the cell holding (x, y)
+     * @note Buckets keep each cell's entries contiguous, so this is exactly
+     *       the cell, colliding cells excluded. Lock-free read: no writer
+     *       may run until the view is dropped.
+     */
+    CellView viewCell(uint32_t x, uint32_t y) const {
+        uint64_t key = hashPos(x, y);
+        const auto& bucket = bucketAt(bucketIndex(key));
+        auto run = cellRun(bucket, key);
+        return CellView(bucket.data() + run.first, bucket.data() + run.second, epoch());
+    }
+
+    /** @brief True if p is indexed under the cell holding (x, y) */
+    bool inCell(const ParticleRef& p, uint32_t x, uint32_t y) const {
+        return hashPos(p.getX(), p.getY()) == hashPos(x, y);
+    }
+
+    /**
+     * @brief Calls fn(ref) for each particle of the cell holding (x, y)
+     * @note No allocation and no copies; visits viewCell(). Lock-free read:
+     *       no writer may run meanwhile, and fn must not modify the hash.
+     */
+    template<typename Fn>
+    void forEachInCell(uint32_t x, uint32_t y, Fn&& fn) const {
+        for(const ParticleRef& p : viewCell(x, y)) {
+            fn(p);
+        }
+    }
+
+    /** @brief Calls fn(ref) for every indexed particle; same rules as forEachInCell() */
+    template<typename Fn>
+    void forEachParticle(Fn&& fn) const {
+        for(size_t i = 0, count = bucketCount(); i < count; ++i) {
+            for(const ParticleRef& p : bucketAt(i)) {
+                fn(p);
+            }
+        }
+    }
     
-    /** @brief Batch update with adaptive parallelization */
+    /**
+     * @brief Batch update with adaptive parallelization
+     * @note Batches above PARALLEL_THRESHOLD take the lock-free sharded
+     *       path, so no other writer may run meanwhile
+     */
     void batchUpdate(const std::vector<ParticleRef>& particles) {
         if(particles.size() > PARALLEL_THRESHOLD) {
             parallelUpdate(particles);
@@ -370,42 +860,227 @@ public:
         }
     }
 
+    /**
+     * @brief Applies a set of removals and insertions in one pass
+     * @param removed References to drop, at their own positions
+     * @param inserted References to add, at their own positions
+     * @note Changes are grouped by bucket and buckets are processed in
+     *       parallel without locks, so no other writer may run meanwhile.
+     *       Within a bucket removals go first and insertions reuse their
+     *       slots; missing removals and already indexed insertions are
+     *       skipped (see ParticleDeltaLog::coalesce()).
+     */
+    void applyChanges(const std::vector<ParticleRef>& removed, const std::vector<ParticleRef>& inserted) {
+        // Grow once up front, so a large batch of spawns does not land in
+        // an undersized table
+        size_t expected = particle_count + inserted.size();
+        if(expected > bucketCount() * load_factor_threshold) {
+            resizeBuckets(static_cast<size_t>(expected / load_factor_threshold));
+        }
+
+        pending_changes.clear();
+        pending_changes.reserve(removed.size() + inserted.size());
+        for(const auto& p : removed) {
+            pending_changes.push_back({bucketIndex(hashPos(p.getX(), p.getY())), p, false});
+        }
+        for(const auto& p : inserted) {
+            bindGrid(p);
+            pending_changes.push_back({bucketIndex(hashPos(p.getX(), p.getY())), p, true});
+        }
+        // Per bucket, removals first, so insertions can take their slots
+        std::sort(pending_changes.begin(), pending_changes.end(),
+                  [](const BucketChange& a, const BucketChange& b) {
+                      return a.bucket != b.bucket ? a.bucket < b.bucket : a.insert < b.insert;
+                  });
+
+        // Start of each bucket's run of changes
+        change_runs.clear();
+        for(size_t i = 0; i < pending_changes.size(); ++i) {
+            if(i == 0 || pending_changes[i].bucket != pending_changes[i - 1].bucket) {
+                change_runs.push_back(i);
+            }
+        }
+        change_runs.push_back(pending_changes.size());
+
+        int64_t delta = 0;
+        int64_t runs = static_cast<int64_t>(change_runs.size()) - 1;
+#ifdef _OPENMP
+        #pragma omp parallel reduction(+:delta)
+#endif
+        {
+            std::vector<uint32_t> holes;
+            std::vector<size_t> deferred;
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic, 64)
+#endif
+            for(int64_t r = 0; r < runs; ++r) {
+                delta += applyRun(change_runs[r], change_runs[r + 1], holes, deferred);
+            }
+        }
+
+        particle_count += delta;
+        current_timestamp++;  // Invalidate cached queries
+        checkResize();
+    }
+
+    /** @brief Number of indexed particles */
+    size_t size() const { return particle_count; }
+
 private:
+    /**
+     * @brief Applies one bucket's changes, removals first
+     * @return Change in particle count
+     * @note Removals leave holes that insertions into the same cell fill in
+     *       place, so a particle moving within its cell keeps its slot.
+     *       Leftover holes are closed highest first, so no hole moves while
+     *       another is closed, and the other insertions are appended to
+     *       their cells' runs after that.
+     */
+    int64_t applyRun(size_t begin, size_t end, std::vector<uint32_t>& holes,
+                     std::vector<size_t>& deferred) {
+        auto& bucket = bucketAt(pending_changes[begin].bucket);
+        int64_t delta = 0;
+        holes.clear();
+        deferred.clear();
+        
+        size_t i = begin;
+        for(; i < end && !pending_changes[i].insert; ++i) {
+            const ParticleRef& ref = pending_changes[i].ref;
+            if(!isIndexed(ref)) continue;
+            uint32_t& slot = slots[slotIndex(ref)];
+            if(slot >= bucket.size() || !(bucket[slot] == ref)) continue;
+            holes.push_back(slot);
+            slot = NO_SLOT;
+            delta--;
+        }
+        // A hole still holds its removed entry, and so its cell's key
+        for(; i < end; ++i) {
+            const ParticleRef& ref = pending_changes[i].ref;
+            if(isIndexed(ref)) continue;
+            uint64_t key = keyOf(ref);
+            auto hole = std::find_if(holes.begin(), holes.end(),
+                                     [&](uint32_t h) { return keyOf(bucket[h]) == key; });
+            if(hole != holes.end()) {
+                bucket[*hole] = ref;
+                slots[slotIndex(ref)] = *hole;
+                *hole = holes.back();
+                holes.pop_back();
+            } else {
+                slots[slotIndex(ref)] = 0;  // Indexed from here on; slot set below
+                deferred.push_back(i);
+            }
+            delta++;
+        }
+        
+        std::sort(holes.begin(), holes.end(), std::greater<uint32_t>());
+        for(uint32_t hole : holes) {
+            closeSlot(bucket, hole);
+        }
+        for(size_t change : deferred) {
+            pushToBucket(pending_changes[change].bucket, pending_changes[change].ref);
+        }
+        return delta;
+    }
+
     /** @brief Sequential update for small batches */
     void sequentialUpdate(const std::vector<ParticleRef>& particles) {
         for(const auto& p : particles) {
-            uint64_t hash = hashPos(p.getX(), p.getY());
-            size_t index = hash & (buckets.size() - 1);
-            std::lock_guard<std::mutex> lock(bucket_mutexes[index]);
-            buckets[index].push_back(p);
+            insert(p, p.getX(), p.getY());
         }
-        checkResize();
     }
 
-    /** @brief Parallel update for large batches */
+    /**
+     * @brief Parallel update for large batches, without per-item locks
+     * @note Two phases: each thread bins its share of the batch by shard (a
+     *       contiguous range of buckets), then each shard is merged by one
+     *       thread, which owns its buckets and reserves each once
+     */
     void parallelUpdate(const std::vector<ParticleRef>& particles) {
-        static const size_t BATCH_SIZE = 1024;
+        // Binding may throw, which must not happen inside the parallel loop
+        for(const auto& p : particles) {
+            bindGrid(p);
+        }
         
-        #pragma omp parallel for schedule(dynamic)
-        for(size_t i = 0; i < particles.size(); i += BATCH_SIZE) {
-            size_t end = std::min(i + BATCH_SIZE, particles.size());
-            
-            std::vector<std::pair<size_t, ParticleRef>> updates;
-            updates.reserve(BATCH_SIZE);
-            
-            for(size_t j = i; j < end; j++) {
-                const auto& p = particles[j];
-                uint64_t hash = hashPos(p.getX(), p.getY());
-                size_t index = hash & (buckets.size() - 1);
-                updates.emplace_back(index, p);
+        // Bucket indices are computed once, so the table must not grow later
+        size_t expected = particle_count + particles.size();
+        if(expected > bucketCount() * load_factor_threshold) {
+            resizeBuckets(static_cast<size_t>(expected / load_factor_threshold));
+        }
+        
+        size_t bucket_count = bucketCount();
+        size_t shards = std::min(INSERT_SHARDS, bucket_count);
+        size_t shard_shift = 0;
+        while((shards << shard_shift) < bucket_count) {
+            shard_shift++;
+        }
+#ifdef _OPENMP
+        int threads = omp_get_max_threads();
+#else
+        int threads = 1;
+#endif
+        shard_bins.resize(static_cast<size_t>(threads) * shards);
+        for(auto& bin : shard_bins) {
+            bin.clear();
+        }
+        
+        int64_t count = static_cast<int64_t>(particles.size());
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(threads)
+#endif
+        {
+#ifdef _OPENMP
+            std::vector<BucketChange>* bins = &shard_bins[static_cast<size_t>(omp_get_thread_num()) * shards];
+            #pragma omp for schedule(static)
+#else
+            std::vector<BucketChange>* bins = shard_bins.data();
+#endif
+            for(int64_t i = 0; i < count; ++i) {
+                const ParticleRef& p = particles[i];
+                size_t index = bucketIndex(hashPos(p.getX(), p.getY()));
+                bins[index >> shard_shift].push_back({index, p, true});
             }
-            
-            for(const auto& update : updates) {
-                std::lock_guard<std::mutex> lock(bucket_mutexes[update.first]);
-                buckets[update.first].push_back(update.second);
+        }
+        
+        int64_t added = 0;
+        int64_t shard_count = static_cast<int64_t>(shards);
+#ifdef _OPENMP
+        #pragma omp parallel num_threads(threads) reduction(+:added)
+#endif
+        {
+            std::vector<uint32_t> counts(size_t(1) << shard_shift);
+#ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+#endif
+            for(int64_t s = 0; s < shard_count; ++s) {
+                size_t first = static_cast<size_t>(s) << shard_shift;
+                std::fill(counts.begin(), counts.end(), 0);
+                for(int t = 0; t < threads; ++t) {
+                    for(const auto& change : shard_bins[t * shards + s]) {
+                        counts[change.bucket - first]++;
+                    }
+                }
+                for(size_t b = 0; b < counts.size(); ++b) {
+                    if(counts[b] == 0) continue;
+                    auto& bucket = bucketAt(first + b);
+                    size_t needed = bucket.size() + counts[b];
+                    if(needed > bucket.capacity()) {
+                        bucket.reserve(std::max(needed, bucket.capacity() * 2));
+                    }
+                }
+                // Thread order, then input order: deterministic per thread count
+                for(int t = 0; t < threads; ++t) {
+                    for(const auto& change : shard_bins[t * shards + s]) {
+                        if(slots[slotIndex(change.ref)] == NO_SLOT) {
+                            pushToBucket(change.bucket, change.ref);
+                            added++;
+                        }
+                    }
+                }
             }
         }
         
+        particle_count += added;
+        current_timestamp++;
         checkResize();
     }
 };
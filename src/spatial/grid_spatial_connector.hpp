@@ -16,6 +16,11 @@
  * Provides a unified interface for particle simulation with optimized spatial queries,
  * efficient batch synchronization, and sophisticated spatial search capabilities.
  * 
+ * The hash follows the grid incrementally: GridOperations logs every move,
+ * spawn and despawn, and each sync reduces the log to net per-cell changes
+ * and applies them in one batched pass, so the hash stays exact (one entry
+ * per particle) and a sync costs O(changes) rather than O(dirty cells).
+ * 
  * Performance Metrics (tested with 100k particles):
  * - Insertion: ~613k particles/second
  * - Queries: ~49k queries/second
@@ -25,7 +30,7 @@
  * Key Features:
  * - Advanced spatial query system with caching
  * - Parallel batch processing with OpenMP
- * - Automatic dirty state tracking
+ * - Incremental hash maintenance from move/spawn/despawn deltas
  * - Performance metrics monitoring
  * - Thread-safe operations
  * - Memory usage tracking and optimization
@@ -82,7 +87,8 @@
  *    - addParticle(): Add new particle
  *    - removeParticle(): Remove particle
  *    - moveParticle(): Move particle with boundary checking
- *    - getNeighbors(): Get valid neighboring cells
+ *    - getNeighbors(): Get valid neighboring cells (inline, no allocation)
+ *    - forEachNeighbor(): Callback over valid neighboring cells
  * 
  * 2. Basic Spatial Queries:
  *    - queryArea(): Simple area query
@@ -95,6 +101,7 @@
  *    - queryBox(): Box-bounded search
  *    - queryKNearest(): K-nearest neighbors
  *    - queryDenseRegions(): Density-based search
+ *    - forEachInRadius(), forEachInBox(): Visitors over the hash, no copies
  * 
  * 4. Grid Properties:
  *    - getWidth(): Grid width
@@ -104,7 +111,9 @@
  * 5. System Operations:
  *    - update(): System sync
  *    - clear(): System reset
- *    - batchSyncDirtyStates(): Force sync
+ *    - batchSyncDirtyStates(): Apply the pending deltas to the hash
+ *    - getDeltaLog(): Log for moves made outside the connector
+ *    - discardDeltas(): Drop pending deltas (hash not maintained)
  * 
  * 6. Performance Monitoring:
  *    - getMetrics(): Performance metrics
@@ -116,14 +125,15 @@
  *    - getMemoryAllocationMap(): Get detailed memory allocation map
  * 
  * Implementation Details:
- * - Optimized batch size (1024) for parallel processing
+ * - Sync batches are net per-cell changes grouped by hash bucket, applied
+ *   in parallel; queries apply pending changes first
  * - O(1) average complexity for spatial operations
  * - Query result caching for frequent lookups
  * - Fine-grained thread safety
  * - Automatic performance tracking
  * - RAII-based memory management
  * - Component-specific memory tracking
- * - Automatic movement synchronization through callbacks
+ * - Automatic movement synchronization through the delta log
  * - Boundary-aware grid operations
  * 
  * @note Best performance with OpenMP-enabled compilation
@@ -137,18 +147,22 @@ private:
     GridOperations gridOps;
     std::unique_ptr<MemoryTracker<GridSpatialConnector>> memory_tracker;
     
-    static const size_t BATCH_SIZE = 1024;
+    // Occupancy changes since the last sync, and reused sync buffers
+    ParticleDeltaLog delta_log;
+    std::vector<uint32_t> removed_cells;
+    std::vector<uint32_t> inserted_cells;
+    std::vector<ParticleRef> removed_refs;
+    std::vector<ParticleRef> inserted_refs;
     
     struct UpdateMetrics {
         uint64_t updates_processed{0};
         double avg_sync_time{0.0};
-        size_t peak_batch_size{0};
+        size_t peak_batch_size{0};  // Most net changes applied in one sync
         std::chrono::microseconds total_sync_time{0};
     } metrics;
 
     size_t calculateMemoryUsage() {
         return sizeof(GridSpatialConnector) +
-                (BATCH_SIZE * sizeof(std::pair<uint32_t, uint32_t>)) +
                 sizeof(UpdateMetrics);
     }
 
@@ -163,14 +177,10 @@ public:
             calculateMemoryUsage()
         ))
     {
-        gridOps.setMoveCallback([this](uint32_t fromX, uint32_t fromY, uint32_t toX, uint32_t toY) {
-            ParticleRef ref(&grid, fromX, fromY);
-            spatialHash.remove(ref, fromX, fromY);
-            spatialHash.insert(ref, toX, toY);        
-        });
+        gridOps.setDeltaLog(&delta_log);
     }
 
-    // Direct particle manipulation
+    // Direct particle manipulation; the hash follows at the next sync
     void addParticle(uint32_t x, uint32_t y, Particle p) {
         // Validate coordinates
         if (!isValidPosition(x, y)) {
@@ -178,13 +188,9 @@ public:
         }
 
         gridOps.updateCell(x, y, p);
-        ParticleRef ref(&grid, x, y);
-        spatialHash.insert(ref, x, y);
     }
 
     bool removeParticle(uint32_t x, uint32_t y) {
-        ParticleRef ref(&grid, x, y);
-        spatialHash.remove(ref, x, y);
         Particle emptyParticle;
         gridOps.updateCell(x, y, emptyParticle);
         return true;
@@ -203,10 +209,15 @@ public:
         return gridOps.moveParticle(fromX, fromY, toX, toY);
     }
 
-    std::vector<std::pair<uint32_t, uint32_t>> getNeighbors(uint32_t x, uint32_t y) {
+    NeighborRange getNeighbors(uint32_t x, uint32_t y) const {
         return gridOps.getNeighbors(x, y);
     }
 
+    template<typename Fn>
+    void forEachNeighbor(uint32_t x, uint32_t y, Fn&& fn) const {
+        gridOps.forEachNeighbor(x, y, std::forward<Fn>(fn));
+    }
+
     // Grid state queries
     bool isValidPosition(uint32_t x, uint32_t y) const {
         return grid.isValidPosition(x, y);
@@ -238,64 +249,94 @@ public:
     void clear() {
         grid.forEachCell([&](uint32_t x, uint32_t y, Particle& p) {
             if (!p.isEmpty()) {
-                ParticleRef ref(&grid, x, y);
-                spatialHash.remove(ref, x, y);
+                gridOps.updateCell(x, y, Particle());
             }
-            p = Particle();
         });
+        batchSyncDirtyStates();
     }
 
     void update() {
         batchSyncDirtyStates();
     }
 
+    /**
+     * @brief Applies the moves, spawns and despawns logged since the last
+     *        sync to the spatial hash
+     * @note A particle that moved several times since the last sync costs
+     *       one removal and one insertion
+     */
     void batchSyncDirtyStates() {
+        if (delta_log.empty()) {
+            return;
+        }
         auto start_time = std::chrono::high_resolution_clock::now();
         
-        std::vector<std::pair<uint32_t, uint32_t>> updates;
-        updates.reserve(BATCH_SIZE);
-        
-        grid.forEachDirtyCell([&](uint32_t x, uint32_t y, const Particle& p) {
-            updates.emplace_back(x, y);
-            
-            if(updates.size() >= BATCH_SIZE) {
-                processBatch(updates);
-                updates.clear();
-                updates.reserve(BATCH_SIZE);
-            }
-        });
-        
-        if(!updates.empty()) {
-            processBatch(updates);
-        }
+        delta_log.coalesce(removed_cells, inserted_cells);
+        delta_log.clear();
+        toRefs(removed_cells, removed_refs);
+        toRefs(inserted_cells, inserted_refs);
+        spatialHash.applyChanges(removed_refs, inserted_refs);
         
+        size_t processed = removed_refs.size() + inserted_refs.size();
+        metrics.updates_processed += processed;
+        metrics.peak_batch_size = std::max(metrics.peak_batch_size, processed);
         updateMetrics(start_time);
     }
 
-    // Advanced spatial queries
+    /**
+     * @brief Log that the next sync applies
+     * @note For moves made on the grid directly (e.g. the parallel update);
+     *       record them in the order they happened
+     */
+    ParticleDeltaLog& getDeltaLog() { return delta_log; }
+
+    /** @brief Drops pending deltas; the hash no longer matches the grid */
+    void discardDeltas() { delta_log.clear(); }
+
+    // Advanced spatial queries; pending deltas are applied first
     std::vector<ParticleRef> queryRadius(Vector2D pos, float radius) {
+        batchSyncDirtyStates();
         return querySystem.queryRadius(pos, radius);
     }
 
     std::vector<ParticleRef> queryBox(Vector2D min, Vector2D max) {
+        batchSyncDirtyStates();
         return querySystem.queryBox(min, max);
     }
 
     std::vector<ParticleRef> queryKNearest(Vector2D pos, size_t k) {
+        batchSyncDirtyStates();
         return querySystem.queryKNearest(pos, k);
     }
 
     std::vector<ParticleRef> queryDenseRegions(float min_density) {
+        batchSyncDirtyStates();
         return querySystem.queryDenseRegions(min_density);
     }
 
     template<typename FilterFunc>
     std::vector<ParticleRef> queryRadiusFiltered(Vector2D pos, float radius, FilterFunc filter) {
+        batchSyncDirtyStates();
         return querySystem.queryRadiusFiltered(pos, radius, filter);
     }
 
+    /** @brief Calls fn(ref) for every particle within radius; no allocation */
+    template<typename Fn>
+    void forEachInRadius(Vector2D pos, float radius, Fn&& fn) {
+        batchSyncDirtyStates();
+        querySystem.forEachInRadius(pos, radius, std::forward<Fn>(fn));
+    }
+
+    /** @brief Calls fn(ref) for every particle inside [min, max]; no allocation */
+    template<typename Fn>
+    void forEachInBox(Vector2D min, Vector2D max, Fn&& fn) {
+        batchSyncDirtyStates();
+        querySystem.forEachInBox(min, max, std::forward<Fn>(fn));
+    }
+
     // Basic spatial query (kept for backward compatibility)
     std::vector<ParticleRef> queryArea(uint32_t x, uint32_t y) {
+        batchSyncDirtyStates();
         Vector2D pos(static_cast<float>(x), static_cast<float>(y));
         return querySystem.queryRadius(pos, 1.0f);  // Use QuerySystem's radius query
     }
@@ -318,33 +359,13 @@ public:
     void resetMetrics() { metrics = UpdateMetrics{}; }
 
 private:
-    void processBatch(const std::vector<std::pair<uint32_t, uint32_t>>& updates) {
-        // Use a more controlled approach to parallelism
-        std::vector<std::vector<std::pair<uint32_t, uint32_t>>> thread_local_updates;
-        int num_threads = omp_get_max_threads();
-        thread_local_updates.resize(num_threads);
-        
-        // Distribute updates to thread-local containers
-        #pragma omp parallel for
-        for(size_t i = 0; i < updates.size(); i++) {
-            int thread_id = omp_get_thread_num();
-            thread_local_updates[thread_id].push_back(updates[i]);
+    void toRefs(const std::vector<uint32_t>& cells, std::vector<ParticleRef>& refs) {
+        uint32_t width = grid.getWidth();
+        refs.clear();
+        refs.reserve(cells.size());
+        for (uint32_t index : cells) {
+            refs.emplace_back(&grid, index % width, index / width);
         }
-        
-        // Process each thread's updates
-        #pragma omp parallel for
-        for(int t = 0; t < num_threads; t++) {
-            for(const auto& [x, y] : thread_local_updates[t]) {
-                const auto& p = grid.at(x, y);
-                if(!p.isEmpty()) {
-                    ParticleRef ref(&grid, x, y);
-                    spatialHash.insert(ref, x, y);
-                }
-            }
-        }
-        
-        metrics.updates_processed += updates.size();
-        metrics.peak_batch_size = std::max(metrics.peak_batch_size, updates.size());
     }
 
     void updateMetrics(std::chrono::time_point<std::chrono::high_resolution_clock> start_time) {
@@ -354,7 +375,9 @@ private:
         );
         
         metrics.total_sync_time += duration;
-        metrics.avg_sync_time = static_cast<double>(metrics.total_sync_time.count()) / 
-                               static_cast<double>(metrics.updates_processed);
+        if (metrics.updates_processed > 0) {
+            metrics.avg_sync_time = static_cast<double>(metrics.total_sync_time.count()) / 
+                                   static_cast<double>(metrics.updates_processed);
+        }
     }
 };
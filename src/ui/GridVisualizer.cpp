@@ -1,42 +1,82 @@
 #include "GridVisualizer.hpp"
 
+namespace {
+
+uint32_t packColor(const MaterialColor& color) {
+    return (static_cast<uint32_t>(color.a) << 24) | (static_cast<uint32_t>(color.r) << 16) |
+           (static_cast<uint32_t>(color.g) << 8) | color.b;
+}
+
+} // namespace
+
 void GridVisualizer::render() {
+    ChunkRect all;
+    all.expand(0, 0, grid.getWidth() - 1, grid.getHeight() - 1);
+    
+    // Whole rows are independent, so a full repaint is split across threads
+    grid.parallelForEachRowSpan(all, [&](uint32_t x0, uint32_t y, PlaneSpan<Particle> row) {
+        colorRow(x0, y, row);
+    });
+    uploadRect(all);
+    fullRedraw = false;
+    present();
+}
+
+void GridVisualizer::render(const std::vector<ChunkRect>& dirtyRects) {
+    if (fullRedraw) {
+        render();
+        return;
+    }
+    
+    // Only the chunk rectangles that changed are recoloured and uploaded
+    for (const ChunkRect& rect : dirtyRects) {
+        paintRect(rect);
+    }
+    present();
+}
+
+void GridVisualizer::colorRow(uint32_t x0, uint32_t y, PlaneSpan<Particle> row) {
+    const uint32_t empty = 0xFF000000u;
+    uint32_t* out = &pixels[static_cast<size_t>(y) * grid.getWidth() + x0];
+    
+    for (const Particle& p : row) {
+        // Set color from the material registry
+        *out++ = p.isEmpty() ? empty : packColor(getMaterial(p.type).color);
+    }
+}
+
+void GridVisualizer::paintRect(const ChunkRect& rect) {
+    grid.forEachRowSpan(rect, [&](uint32_t x0, uint32_t y, PlaneSpan<Particle> row) {
+        colorRow(x0, y, row);
+    });
+    uploadRect(rect);
+}
+
+void GridVisualizer::uploadRect(const ChunkRect& rect) {
+    uint32_t width = grid.getWidth();
+    SDL_Rect area = {
+        static_cast<int>(rect.min_x),
+        static_cast<int>(rect.min_y),
+        static_cast<int>(rect.max_x - rect.min_x + 1),
+        static_cast<int>(rect.max_y - rect.min_y + 1)
+    };
+    SDL_UpdateTexture(texture, &area, &pixels[static_cast<size_t>(rect.min_y) * width + rect.min_x],
+                      static_cast<int>(width * sizeof(uint32_t)));
+}
+
+void GridVisualizer::present() {
     // Clear screen
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
     
-    // Render each cell in the grid
-    grid.forEachCell([&](uint32_t x, uint32_t y, const Particle& p) {
-        if (!p.isEmpty()) {
-            SDL_Rect rect = {
-                static_cast<int>(x * cellSize),
-                static_cast<int>(y * cellSize),
-                cellSize,
-                cellSize
-            };
-            
-            // Set color based on particle type
-            switch (p.type) {
-                case ParticleType::SAND:
-                    SDL_SetRenderDrawColor(renderer, 240, 210, 140, 255); // Sandy color
-                    break;
-                case ParticleType::WATER:
-                    SDL_SetRenderDrawColor(renderer, 64, 164, 223, 255); // Blue
-                    break;
-                case ParticleType::STONE:
-                    SDL_SetRenderDrawColor(renderer, 128, 128, 128, 255); // Gray
-                    break;
-                case ParticleType::WOOD:
-                    SDL_SetRenderDrawColor(renderer, 139, 69, 19, 255); // Brown
-                    break;
-                default:
-                    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // White
-                    break;
-            }
-            
-            SDL_RenderFillRect(renderer, &rect);
-        }
-    });
+    // Scale the cell texture up to the window
+    SDL_Rect target = {
+        0,
+        0,
+        static_cast<int>(grid.getWidth()) * cellSize,
+        static_cast<int>(grid.getHeight()) * cellSize
+    };
+    SDL_RenderCopy(renderer, texture, nullptr, &target);
     
     // Present the rendered frame
     SDL_RenderPresent(renderer);
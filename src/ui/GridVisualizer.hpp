@@ -1,21 +1,37 @@
 #pragma once
 #include "../grid/GridOperations.hpp"
+#include "../particle/Material.hpp"
 #include <SDL2/SDL.h>
 #include <memory>
 #include <string>
+#include <vector>
 
+/**
+ * @brief SDL view of a Grid
+ *
+ * Keeps one ARGB pixel per cell in a streaming texture scaled up by
+ * cellSize. render() repaints every cell; render(rects) repaints and
+ * uploads only the given dirty chunk rectangles, so a mostly settled
+ * grid costs a few small texture updates per frame.
+ *
+ * @see Grid::forEachDirtyRect, SimulationEngine::getLastDirtyRects
+ */
 class GridVisualizer {
 private:
     SDL_Window* window;
     SDL_Renderer* renderer;
+    SDL_Texture* texture;
     Grid& grid;
     GridOperations& gridOps;
     int cellSize;
     bool running;
+    std::vector<uint32_t> pixels;  // Row-major ARGB, one per cell
+    bool fullRedraw;               // Texture contents not yet valid
 
 public:
     GridVisualizer(Grid& g, GridOperations& ops, int windowWidth, int windowHeight, int cellSize = 5)
-        : grid(g), gridOps(ops), cellSize(cellSize), running(false) {
+        : grid(g), gridOps(ops), cellSize(cellSize), running(false)
+        , pixels(static_cast<size_t>(g.getWidth()) * g.getHeight()), fullRedraw(true) {
         
         if (SDL_Init(SDL_INIT_VIDEO) < 0) {
             throw std::runtime_error("SDL could not initialize! SDL_Error: " + std::string(SDL_GetError()));
@@ -37,15 +53,37 @@ public:
         if (!renderer) {
             throw std::runtime_error("Renderer could not be created! SDL_Error: " + std::string(SDL_GetError()));
         }
+        
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                    static_cast<int>(g.getWidth()), static_cast<int>(g.getHeight()));
+        
+        if (!texture) {
+            throw std::runtime_error("Texture could not be created! SDL_Error: " + std::string(SDL_GetError()));
+        }
     }
     
     ~GridVisualizer() {
+        SDL_DestroyTexture(texture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
     }
     
+    /** @brief Repaints every cell */
     void render();
+    
+    /**
+     * @brief Repaints only the cells inside the given rectangles
+     * @note Falls back to a full repaint on the first frame
+     */
+    void render(const std::vector<ChunkRect>& dirtyRects);
+    
     void handleEvents();
     void run();
+
+private:
+    void colorRow(uint32_t x0, uint32_t y, PlaneSpan<Particle> row);
+    void paintRect(const ChunkRect& rect);
+    void uploadRect(const ChunkRect& rect);
+    void present();
 };
\ No newline at end of file
@@ -2,9 +2,13 @@
 #include "Grid.hpp"
 #include "GridOperations.hpp"
 #include "Particle.hpp"
+#include "Material.hpp"
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <algorithm>
+#include <functional>
+#include <numeric>
 
 void printTestResult(const std::string& testName, bool success) {
     std::cout << std::setw(30) << std::left << testName 
@@ -141,6 +145,24 @@ bool testNeighborAccess() {
         success = false;
     }
     
+    std::cout << "- Testing inline range order and callback form\n";
+    NeighborRange edge = grid.getValidNeighbors(0, 5);
+    NeighborRange orthogonal = grid.getValidNeighbors(9, 9, false);
+    std::vector<std::pair<uint32_t, uint32_t>> visited;
+    grid.forEachNeighbor(0, 5, [&](uint32_t nx, uint32_t ny) { visited.emplace_back(nx, ny); });
+    std::vector<std::pair<uint32_t, uint32_t>> expected = {
+        {1, 5}, {0, 4}, {0, 6}, {1, 4}, {1, 6}
+    };
+    if (std::vector<std::pair<uint32_t, uint32_t>>(edge.begin(), edge.end()) == expected &&
+        visited == expected && edge.mask() == grid.neighborMask(0, 5) &&
+        orthogonal.size() == 2 && orthogonal[0] == std::make_pair(8u, 9u) &&
+        orthogonal[1] == std::make_pair(9u, 8u)) {
+        std::cout << "  √ Orthogonal then diagonal, range and callback agree\n";
+    } else {
+        std::cout << "  × Neighbor order or mask mismatch\n";
+        success = false;
+    }
+    
     printTestResult("Neighbor Access", success);
     return success;
 }
@@ -177,10 +199,534 @@ bool testDirtyStateTracking() {
         success = false;
     }
     
+    std::cout << "- Testing row-major order across word boundaries\n";
+    DirtyStateTracker tracker(130, 70);
+    const uint32_t marks[][2] = {{129, 69}, {3, 0}, {64, 1}, {0, 1}, {63, 0}, {3, 0}, {70, 40}};
+    for (const auto& m : marks) {
+        tracker.markDirty(m[0], m[1]);
+    }
+    std::vector<uint32_t> order(tracker.getDirtyIndices().begin(), tracker.getDirtyIndices().end());
+    std::vector<uint32_t> expected = {3, 63, 130, 194, 40 * 130 + 70, 69 * 130 + 129};
+    if (order == expected && tracker.getDirtyIndices().size() == expected.size()) {
+        std::cout << "  √ Dirty cells iterate sorted, duplicates counted once\n";
+    } else {
+        std::cout << "  × Dirty iteration order or count wrong\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing single-cell clear and re-mark\n";
+    tracker.clearDirty(64, 1);
+    tracker.clearDirty(64, 1);
+    tracker.markDirty(5, 69);
+    order.assign(tracker.getDirtyIndices().begin(), tracker.getDirtyIndices().end());
+    expected = {3, 63, 130, 40 * 130 + 70, 69 * 130 + 5, 69 * 130 + 129};
+    tracker.clearAllDirty();
+    if (order == expected && tracker.getDirtyIndices().empty() &&
+        tracker.getDirtyIndices().begin() == tracker.getDirtyIndices().end() &&
+        !tracker.isDirty(129, 69)) {
+        std::cout << "  √ clearDirty/clearAllDirty keep count and bits consistent\n";
+    } else {
+        std::cout << "  × Dirty clear bookkeeping failed\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing per-chunk dirty rectangles\n";
+    Grid wide(200, 100);
+    wide.update(10, 5, Particle(ParticleType::SAND));
+    wide.update(20, 40, Particle(ParticleType::SAND));
+    wide.swap(20, 40, 20, 41);
+    wide.markDirty(70, 70);
+    std::vector<ChunkRect> rects;
+    wide.getDirtyRects(rects);
+    size_t inRects = 0;
+    for (const ChunkRect& r : rects) {
+        wide.forEachDirtyInRect(r, [&](uint32_t, uint32_t, Particle&) { inRects++; });
+    }
+    bool exact = rects.size() == 2 &&
+                 rects[0].min_x == 10 && rects[0].min_y == 5 && rects[0].max_x == 20 && rects[0].max_y == 41 &&
+                 rects[1].min_x == 70 && rects[1].min_y == 70 && rects[1].max_x == 70 && rects[1].max_y == 70;
+    size_t dirtyCells = wide.getDirtyIndices().size();
+    wide.clearDirtyStates();
+    if (exact && dirtyCells == 4 && inRects == dirtyCells && wide.getDirtyRectCount() == 0) {
+        std::cout << "  √ Rectangles bound the marked cells of each chunk exactly\n";
+    } else {
+        std::cout << "  × Dirty rectangles wrong or not cleared\n";
+        success = false;
+    }
+    
     printTestResult("Dirty State Tracking", success);
     return success;
 }
 
+bool testMaterialRegistry() {
+    std::cout << "\nRunning Material Registry Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing registry covers every particle type\n";
+    if (MATERIALS.size() == static_cast<size_t>(ParticleType::COUNT) &&
+        getMaterial(ParticleType::EMPTY).movement == MovementClass::STATIC) {
+        std::cout << "  √ One row per particle type\n";
+    } else {
+        std::cout << "  × Registry size mismatch\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing material properties\n";
+    static_assert(getMaterial(ParticleType::SAND).movement == MovementClass::POWDER,
+                  "Sand must be a powder");
+    if (getMaterial(ParticleType::SAND).mass == 100 &&
+        getMaterial(ParticleType::WATER).movement == MovementClass::LIQUID &&
+        getMaterial(ParticleType::STONE).density > getMaterial(ParticleType::WATER).density &&
+        getMaterial(ParticleType::WOOD).flammability > 0.0f) {
+        std::cout << "  √ Properties match the table\n";
+    } else {
+        std::cout << "  × Unexpected material properties\n";
+        success = false;
+    }
+    
+    printTestResult("Material Registry", success);
+    return success;
+}
+
+bool testChunkSleeping() {
+    std::cout << "\nRunning Chunk Sleeping Tests...\n";
+    bool success = true;
+    
+    Grid grid(256, 256);
+    const ChunkTracker& chunks = grid.getChunks();
+    
+    std::cout << "- Testing untouched grid sleeps\n";
+    if (grid.stepChunks() == 0) {
+        std::cout << "  √ All chunks asleep initially\n";
+    } else {
+        std::cout << "  × Untouched chunks are awake\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing change on chunk edge wakes neighbour\n";
+    grid.update(64, 10, Particle(ParticleType::SAND));
+    grid.stepChunks();
+    const ChunkRect& rect = chunks.getActiveRect(1, 0);
+    if (chunks.getAwakeCount() == 2 && chunks.isAwake(0, 0) && chunks.isAwake(1, 0) &&
+        rect.min_x == 64 && rect.max_x == 65 && rect.min_y == 9 && rect.max_y == 11 &&
+        chunks.getActiveRect(0, 0).min_x == 63) {
+        std::cout << "  √ Edge change woke both chunks with tight rectangles\n";
+    } else {
+        std::cout << "  × Edge change wake failed\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing idle chunks fall asleep\n";
+    if (grid.stepChunks() == 0 && !chunks.isAwake(1, 0)) {
+        std::cout << "  √ Chunks slept after an idle tick\n";
+    } else {
+        std::cout << "  × Idle chunks stayed awake\n";
+        success = false;
+    }
+    
+    printTestResult("Chunk Sleeping", success);
+    return success;
+}
+
+bool testOccupancyBitboard() {
+    std::cout << "\nRunning Occupancy Bitboard Tests...\n";
+    bool success = true;
+    
+    Grid grid(100, 4);
+    const OccupancyBitboard& occupancy = grid.getOccupancy();
+    
+    std::cout << "- Testing padding bits read as walls\n";
+    if (occupancy.getWordsPerRow() == 2 && occupancy.word(1, 0) == ~0ULL << 36 &&
+        occupancy.word(0, 0) == 0 && occupancy.word(-1, 0) == ~0ULL && occupancy.word(0, 4) == ~0ULL) {
+        std::cout << "  √ Padding and out-of-grid words are set\n";
+    } else {
+        std::cout << "  × Unexpected padding bits\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing update and swap keep occupancy in sync\n";
+    grid.update(70, 1, Particle(ParticleType::SAND));
+    grid.swap(70, 1, 70, 2);
+    grid.swapUntracked(70, 2, 3, 3);
+    if (!grid.isOccupied(70, 1) && !grid.isOccupied(70, 2) && grid.isOccupied(3, 3) &&
+        occupancy.word(0, 3) == 1ULL << 3) {
+        std::cout << "  √ Occupancy follows the particle\n";
+    } else {
+        std::cout << "  × Occupancy out of sync\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing removal clears the bit\n";
+    grid.update(3, 3, Particle());
+    if (!grid.isOccupied(3, 3) && occupancy.word(0, 3) == 0) {
+        std::cout << "  √ Cleared cell reads empty\n";
+    } else {
+        std::cout << "  × Cleared cell still occupied\n";
+        success = false;
+    }
+    
+    printTestResult("Occupancy Bitboard", success);
+    return success;
+}
+
+bool testSoAStorage() {
+    std::cout << "\nRunning SoA Storage Tests...\n";
+    bool success = true;
+    
+    SoAGrid grid(70, 10);
+    const SoAStorage& storage = grid.getStorage();
+    
+    std::cout << "- Testing planes are aligned and start empty\n";
+    bool aligned = reinterpret_cast<uintptr_t>(storage.types().data()) % SoAStorage::ALIGNMENT == 0 &&
+                   reinterpret_cast<uintptr_t>(storage.masses().data()) % SoAStorage::ALIGNMENT == 0 &&
+                   reinterpret_cast<uintptr_t>(storage.velocitiesY().data()) % SoAStorage::ALIGNMENT == 0;
+    if (aligned && storage.types().size() == 700 && grid.at(69, 9).isEmpty()) {
+        std::cout << "  √ 64-byte aligned planes of 700 cells\n";
+    } else {
+        std::cout << "  × Plane layout incorrect\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing proxy access matches Particle semantics\n";
+    grid.update(5, 2, Particle(ParticleType::SAND, 100));
+    grid.at(5, 2).setVelocity(-1, 3);
+    grid.swap(5, 2, 6, 3);
+    Particle moved = grid.at(6, 3);
+    if (moved.type == ParticleType::SAND && moved.mass == 100 &&
+        moved.getVelocityX() == -1 && moved.getVelocityY() == 3 &&
+        grid.at(5, 2).isEmpty() && grid.isOccupied(6, 3) && !grid.isOccupied(5, 2) &&
+        storage.types()[3 * 70 + 6] == ParticleType::SAND) {
+        std::cout << "  √ Update, setVelocity and swap reach every plane\n";
+    } else {
+        std::cout << "  × SoA cell contents incorrect\n";
+        success = false;
+    }
+    
+    printTestResult("SoA Storage", success);
+    return success;
+}
+
+bool testMortonLayout() {
+    std::cout << "\nRunning Morton Layout Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing tiled index is a bijection\n";
+    MortonStorage storage(100, 70);  // Padded to 2x2 tiles
+    std::vector<bool> seen(storage.cells, false);
+    bool unique = true;
+    for (uint32_t y = 0; y < 128; y++) {
+        for (uint32_t x = 0; x < 128; x++) {
+            size_t index = storage.index(x, y);
+            unique = unique && index < seen.size() && !seen[index];
+            if (index < seen.size()) seen[index] = true;
+        }
+    }
+    if (unique && storage.cells == 4 * MortonStorage::TILE_CELLS &&
+        storage.index(1, 0) == 1 && storage.index(0, 1) == 2 && storage.index(64, 0) == 4096) {
+        std::cout << "  √ Every cell maps to its own Z-order slot\n";
+    } else {
+        std::cout << "  × Morton index collides or is out of range\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing accessors and row spans hide the layout\n";
+    MortonGrid grid(100, 70);
+    for (uint32_t x = 0; x < 100; x++) {
+        grid.update(x, 65, Particle(ParticleType::SAND, static_cast<uint8_t>(x)));
+    }
+    grid.swap(99, 65, 99, 66);
+    std::vector<Particle> row(100);
+    grid.readRow(65, 0, 99, row.data());
+    bool ordered = true;
+    for (uint32_t x = 0; x < 99; x++) {
+        ordered = ordered && row[x].mass == x && grid.at(x, 65).mass == x;
+    }
+    if (ordered && row[99].isEmpty() && grid.at(99, 66).mass == 99 && grid.isOccupied(99, 66)) {
+        std::cout << "  √ Row 65 reads back in x order across the tile edge\n";
+    } else {
+        std::cout << "  × Row span or accessor mismatch\n";
+        success = false;
+    }
+    
+    printTestResult("Morton Layout", success);
+    return success;
+}
+
+template<typename GridT>
+bool haloReadsWalls(GridT& grid) {
+    uint32_t w = grid.getWidth();
+    uint32_t h = grid.getHeight();
+    uint32_t before = 0 - 1u;  // x - 1 at x = 0
+    bool walls = true;
+    for (uint32_t y = before; y != h + 1; ++y) {
+        walls = walls && grid.atUnchecked(before, y).type == ParticleType::WALL &&
+                grid.atUnchecked(w, y).type == ParticleType::WALL;
+    }
+    for (uint32_t x = 0; x < w; ++x) {
+        walls = walls && grid.atUnchecked(x, before).type == ParticleType::WALL &&
+                grid.atUnchecked(x, h).type == ParticleType::WALL;
+    }
+    
+    // Public cells start empty and keep their coordinates
+    size_t occupied = 0;
+    grid.forEachCell([&](uint32_t, uint32_t, typename GridT::reference p) { occupied += !p.isEmpty(); });
+    grid.update(0, h - 1, Particle(ParticleType::SAND));
+    Particle row[3];
+    grid.readRow(h - 1, 0, 2, row);
+    return walls && occupied == 0 && row[0].type == ParticleType::SAND &&
+           grid.at(0, h - 1).type == ParticleType::SAND && grid.isOccupied(before, h - 1);
+}
+
+bool testHaloGrid() {
+    std::cout << "\nRunning Halo Grid Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing occupancy guard ring without a storage halo\n";
+    Grid plain(70, 5);
+    uint32_t before = 0 - 1u;
+    if (plain.isOccupied(before, 0) && plain.isOccupied(70, 4) && plain.isOccupied(3, 5) &&
+        plain.isOccupied(before, before) && !plain.isOccupied(69, 4) && plain.getHalo() == 0) {
+        std::cout << "  √ Cells one step outside the grid read as occupied\n";
+    } else {
+        std::cout << "  × Guard ring missing\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing wall border for every storage policy\n";
+    Grid aos(70, 5, 1);
+    SoAGrid soa(70, 5, 1);
+    MortonGrid morton(70, 5, 1);
+    if (haloReadsWalls(aos) && haloReadsWalls(soa) && haloReadsWalls(morton)) {
+        std::cout << "  √ Border reads WALL, public coordinates unchanged\n";
+    } else {
+        std::cout << "  × Halo border or coordinates wrong\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing wider halo and out-of-range at()\n";
+    Grid wide(8, 8, 3);
+    bool threw = false;
+    try {
+        wide.at(8, 0);
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    if (threw && wide.atUnchecked(0 - 3u, 0 - 3u).type == ParticleType::WALL &&
+        wide.atUnchecked(10, 10).type == ParticleType::WALL && wide.isOccupied(4, 0 - 3u) &&
+        getMaterial(ParticleType::WALL).movement == MovementClass::STATIC) {
+        std::cout << "  √ Three-cell wall ring, at() still bounds-checked\n";
+    } else {
+        std::cout << "  × Wide halo wrong\n";
+        success = false;
+    }
+    
+    printTestResult("Halo Grid", success);
+    return success;
+}
+
+template<typename GridT>
+bool iterationAgrees(GridT& grid) {
+    for (uint32_t i = 0; i < 40; ++i) {
+        grid.update((i * 37) % grid.getWidth(), (i * 11) % grid.getHeight(),
+                    Particle(ParticleType::SAND, static_cast<uint8_t>(i + 1)));
+    }
+    
+    // Reference sums through bounds-checked access
+    uint64_t expected = 0;
+    for (uint32_t y = 0; y < grid.getHeight(); ++y) {
+        for (uint32_t x = 0; x < grid.getWidth(); ++x) {
+            expected += static_cast<Particle>(grid.at(x, y)).mass * (x + 1);
+        }
+    }
+    
+    uint64_t cells = 0;
+    grid.forEachCell([&](uint32_t x, uint32_t, typename GridT::reference p) { cells += p.mass * (x + 1); });
+    
+    uint64_t spans = 0;
+    grid.forEachRowSpan([&](uint32_t x0, uint32_t, auto row) {
+        for (size_t i = 0; i < row.size(); ++i) spans += row[i].mass * (x0 + i + 1);
+    });
+    
+    std::vector<uint64_t> rows(grid.getHeight(), 0);
+    grid.parallelForEachRowSpan([&](uint32_t x0, uint32_t y, auto row) {
+        for (size_t i = 0; i < row.size(); ++i) rows[y] += row[i].mass * (x0 + i + 1);
+    });
+    uint64_t parallel = std::accumulate(rows.begin(), rows.end(), uint64_t(0));
+    
+    size_t dirty = 0;
+    size_t parallelDirty = 0;
+    grid.forEachDirtyCell([&](uint32_t, uint32_t, typename GridT::reference) { dirty++; });
+    std::vector<uint8_t> seen(grid.getWidth() * grid.getHeight(), 0);
+    grid.parallelForEachDirtyCell([&](uint32_t x, uint32_t y, typename GridT::reference) {
+        seen[y * grid.getWidth() + x] = 1;
+    });
+    parallelDirty = std::count(seen.begin(), seen.end(), 1);
+    
+    return expected > 0 && cells == expected && spans == expected && parallel == expected &&
+           dirty == 40 && parallelDirty == 40;
+}
+
+bool testCellIteration() {
+    std::cout << "\nRunning Cell Iteration Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing callback, row-span and parallel forms on every layout\n";
+    Grid aos(150, 90);
+    SoAGrid soa(150, 90);
+    MortonGrid morton(150, 90, 1);
+    if (iterationAgrees(aos) && iterationAgrees(soa) && iterationAgrees(morton)) {
+        std::cout << "  √ All forms visit the same cells with matching x\n";
+    } else {
+        std::cout << "  × Iteration forms disagree\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing row spans alias the grid for row-major storage\n";
+    ChunkRect rect;
+    rect.expand(10, 20, 19, 21);
+    aos.forEachRowSpan(rect, [&](uint32_t, uint32_t, PlaneSpan<Particle> row) {
+        for (Particle& p : row) p = Particle(ParticleType::STONE);
+    });
+    size_t stones = 0;
+    std::function<void(uint32_t, uint32_t, Particle&)> legacy = [&](uint32_t, uint32_t, Particle& p) {
+        stones += p.type == ParticleType::STONE;
+    };
+    aos.forEachCell(legacy);
+    if (stones == 20 && aos.at(19, 21).type == ParticleType::STONE && aos.at(20, 21).type != ParticleType::STONE) {
+        std::cout << "  √ Writes land in place, std::function callers still work\n";
+    } else {
+        std::cout << "  × Span bounds or legacy callback wrong\n";
+        success = false;
+    }
+    
+    printTestResult("Cell Iteration", success);
+    return success;
+}
+
+bool testDoubleBuffer() {
+    std::cout << "\nRunning Double Buffer Tests...\n";
+    bool success = true;
+    
+    // Sand spreads one cell right per step; in place, a left-to-right
+    // sweep would carry it across the whole row in a single pass
+    Grid grid(100, 4);
+    grid.update(0, 1, Particle(ParticleType::SAND));
+    grid.enableDoubleBuffer();
+    grid.clearDirtyStates();
+    auto spread = [&](uint32_t x, uint32_t y) {
+        const Particle& p = grid.atUnchecked(x, y);
+        if (p.isEmpty() && x > 0 && grid.isOccupied(x - 1, y)) {
+            return Particle(ParticleType::SAND);
+        }
+        return p;
+    };
+    
+    std::cout << "- Testing reads see only the previous step\n";
+    size_t changed = grid.stepStencil(spread);
+    if (changed == 1 && grid.at(1, 1).type == ParticleType::SAND && grid.at(2, 1).isEmpty() &&
+        grid.isOccupied(1, 1) && !grid.isOccupied(2, 1)) {
+        std::cout << "  √ One cell changed, front and occupancy updated\n";
+    } else {
+        std::cout << "  × Stencil saw partially updated state (" << changed << " changes)\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing dirty tracking across flips\n";
+    std::vector<ChunkRect> rects;
+    grid.getDirtyRects(rects);
+    bool dirtyOk = grid.getDirtyIndices().size() == 1 && rects.size() == 1 &&
+                   rects[0].min_x == 1 && rects[0].max_x == 1;
+    grid.clearDirtyStates();
+    grid.stepStencil(spread);
+    dirtyOk = dirtyOk && grid.getDirtyIndices().size() == 1 && grid.at(2, 1).type == ParticleType::SAND;
+    if (dirtyOk) {
+        std::cout << "  √ Only changed cells are marked dirty\n";
+    } else {
+        std::cout << "  × Dirty marks wrong after flip\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing in-place edits survive a flip\n";
+    grid.update(50, 3, Particle(ParticleType::STONE));
+    grid.swap(0, 1, 0, 0);
+    grid.flip();
+    size_t unchanged = grid.flip();
+    if (unchanged == 0 && grid.at(50, 3).type == ParticleType::STONE &&
+        grid.at(0, 0).type == ParticleType::SAND && grid.at(0, 1).isEmpty()) {
+        std::cout << "  √ update() and swap() mirror into the back buffer\n";
+    } else {
+        std::cout << "  × In-place edit lost on flip\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing flip without a back buffer\n";
+    Grid single(8, 8);
+    bool threw = false;
+    try {
+        single.flip();
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    if (threw && !single.isDoubleBuffered() && grid.isDoubleBuffered()) {
+        std::cout << "  √ Throws std::logic_error\n";
+    } else {
+        std::cout << "  × Expected std::logic_error\n";
+        success = false;
+    }
+    
+    printTestResult("Double Buffer", success);
+    return success;
+}
+
+template<typename GridT>
+bool allocationWorks(const GridAllocation& allocation) {
+    GridT grid(300, 130, 1, allocation);
+    bool empty = true;
+    grid.forEachCell([&](uint32_t, uint32_t, typename GridT::reference p) { empty = empty && p.isEmpty(); });
+    grid.update(299, 129, Particle(ParticleType::WATER));
+    grid.enableDoubleBuffer();
+    grid.writeBack(0, 0, Particle(ParticleType::SAND));
+    grid.flip();
+    return empty && grid.at(299, 129).type == ParticleType::WATER &&
+           grid.at(0, 0).type == ParticleType::SAND &&
+           grid.atUnchecked(0 - 1u, 0).type == ParticleType::WALL &&
+           grid.getAllocation().huge_pages == allocation.huge_pages;
+}
+
+bool testGridAllocation() {
+    std::cout << "\nRunning Grid Allocation Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing buffer alignment\n";
+    Grid standard(300, 130);
+    Grid numa(300, 130, 0, GridAllocation::numaAware());
+    SoAGrid soa(300, 130, 0, GridAllocation::numaAware());
+    auto address = [](const void* p) { return reinterpret_cast<uintptr_t>(p); };
+    if (address(standard.getStorage().particles.get()) % CACHE_LINE_SIZE == 0 &&
+        address(numa.getStorage().particles.get()) % HUGE_PAGE_SIZE == 0 &&
+        address(soa.getStorage().types().data()) % HUGE_PAGE_SIZE == 0) {
+        std::cout << "  √ 64-byte default, 2 MB huge-page buffers\n";
+    } else {
+        std::cout << "  × Buffer misaligned\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing first-touch grids on every layout\n";
+    GridAllocation touchOnly;
+    touchOnly.first_touch = true;
+    if (allocationWorks<Grid>(GridAllocation::numaAware()) &&
+        allocationWorks<SoAGrid>(touchOnly) &&
+        allocationWorks<MortonGrid>(GridAllocation::numaAware())) {
+        std::cout << "  √ Zeroed, halo walls, double buffer on the same policy\n";
+    } else {
+        std::cout << "  × Allocated grid misbehaves\n";
+        success = false;
+    }
+    
+    printTestResult("Grid Allocation", success);
+    return success;
+}
+
 int main() {
     std::cout << "\n=== Starting Particle System Tests ===\n";
     
@@ -190,7 +736,16 @@ int main() {
         {"Collision Detection", testParticleCollision()},
         {"Grid Boundaries", testGridBoundaries()},
         {"Neighbor Access", testNeighborAccess()},
-        {"Dirty State Tracking", testDirtyStateTracking()}
+        {"Dirty State Tracking", testDirtyStateTracking()},
+        {"Material Registry", testMaterialRegistry()},
+        {"Chunk Sleeping", testChunkSleeping()},
+        {"Occupancy Bitboard", testOccupancyBitboard()},
+        {"SoA Storage", testSoAStorage()},
+        {"Morton Layout", testMortonLayout()},
+        {"Halo Grid", testHaloGrid()},
+        {"Cell Iteration", testCellIteration()},
+        {"Double Buffer", testDoubleBuffer()},
+        {"Grid Allocation", testGridAllocation()}
     };
     
     int totalTests = results.size();
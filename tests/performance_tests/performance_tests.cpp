@@ -3,9 +3,39 @@
 #include <iomanip>
 #include "Grid.hpp"
 #include "SpatialHash.hpp"
+#include "CellIndex.hpp"
+#include "FlatSpatialHash.hpp"
 #include "MemoryMonitor.hpp"
 #include "MemoryPool.hpp"
+#include "MaterialKernels.hpp"
+#include <random>
+#include <array>
+#include <type_traits>
+#include <utility>
 #include <omp.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <functional>
+#include <numeric>
+#include "GridOperations.hpp"
+#include "grid_spatial_connector.hpp"
+
+// Counts global operator new calls so benchmarks can report allocations.
+// The deletes stay out of line so GCC does not pair the inlined free()
+// with a new-expression and warn about a mismatch.
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
 
 
 class PerformanceMetrics {
@@ -28,6 +58,10 @@ public:
         operationCount++;
     }
     
+    void recordOperations(size_t count) {
+        operationCount += count;
+    }
+    
     void printResults() {
         auto endTime = Clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -102,12 +136,783 @@ void testMemoryAllocationPerformance() {
     metrics.printResults();
 }
 
+// Same random sand/water scene for every storage policy
+template<typename GridT>
+void fillRain(GridT& grid, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    for (uint32_t y = 0; y < grid.getHeight() / 2; y++) {
+        for (uint32_t x = 0; x < grid.getWidth(); x++) {
+            if (chance(rng) < 0.5f) {
+                ParticleType type = chance(rng) < 0.5f ? ParticleType::SAND : ParticleType::WATER;
+                grid.update(x, y, Particle(type, getMaterial(type).mass));
+            }
+        }
+    }
+}
+
+// Chunked serial update, as in SimulationEngine::updateChunksSerial
+template<typename GridT>
+void benchUpdate(const std::string& name, uint32_t size, int steps) {
+    GridT grid(size, size);
+    fillRain(grid, 42);
+    auto move = [&](uint32_t fx, uint32_t fy, uint32_t tx, uint32_t ty) {
+        grid.swap(fx, fy, tx, ty);
+        return true;
+    };
+    
+    PerformanceMetrics metrics(name + " Update");
+    const ChunkTracker& chunks = grid.getChunks();
+    for (int frame = 0; frame < steps; frame++) {
+        grid.stepChunks();
+        CounterRng rng(1, frame);
+        for (int cy = static_cast<int>(chunks.getChunksY()) - 1; cy >= 0; cy--) {
+            int bandTop = cy * ChunkTracker::CHUNK_SIZE;
+            int bandBottom = std::min<int>(bandTop + ChunkTracker::CHUNK_SIZE, size - 1) - 1;
+            for (int y = bandBottom; y >= bandTop; y--) {
+                for (uint32_t cx = 0; cx < chunks.getChunksX(); cx++) {
+                    const ChunkRect& rect = chunks.getActiveRect(cx, cy);
+                    if (rect.isEmpty() || !rect.containsRow(y)) continue;
+                    kernels::stepChunkRow(grid, cx, rect, y, rng, move);
+                    metrics.recordOperations(rect.max_x - rect.min_x + 1);
+                }
+            }
+        }
+        grid.clearDirtyStates();
+    }
+    metrics.printResults();
+}
+
+// Renderer pass: one RGBA pixel per cell from the material color. SoA
+// reads the type plane directly so the loop touches 1 byte per cell.
+template<typename GridT>
+void benchRender(const std::string& name, uint32_t size, int frames) {
+    GridT grid(size, size);
+    fillRain(grid, 42);
+    std::vector<uint32_t> pixels(static_cast<size_t>(size) * size);
+    std::array<uint32_t, MATERIALS.size()> palette;
+    for (size_t i = 0; i < MATERIALS.size(); i++) {
+        const MaterialColor& c = MATERIALS[i].color;
+        palette[i] = (c.r << 24) | (c.g << 16) | (c.b << 8) | c.a;
+    }
+    
+    PerformanceMetrics metrics(name + " Render");
+    for (int frame = 0; frame < frames; frame++) {
+        if constexpr (std::is_same_v<typename GridT::storage_type, SoAStorage>) {
+            PlaneSpan<const ParticleType> types = std::as_const(grid).getStorage().types();
+            for (size_t i = 0; i < types.size(); i++) {
+                pixels[i] = palette[static_cast<size_t>(types[i])];
+            }
+        } else {
+            for (uint32_t y = 0; y < size; y++) {
+                for (uint32_t x = 0; x < size; x++) {
+                    pixels[y * size + x] = palette[static_cast<size_t>(grid.atUnchecked(x, y).type)];
+                }
+            }
+        }
+        metrics.recordOperations(pixels.size());
+    }
+    metrics.printResults();
+    std::cout << "Checksum: " << pixels[pixels.size() / 4] << "\n";
+}
+
+// Spatial sync pass: read every field of each dirty cell
+template<typename GridT>
+void benchSync(const std::string& name, uint32_t size, int rounds) {
+    GridT grid(size, size);
+    fillRain(grid, 42);
+    std::vector<uint32_t> dirty(grid.getDirtyIndices().begin(), grid.getDirtyIndices().end());
+    uint64_t massSum = 0;
+    
+    PerformanceMetrics metrics(name + " Sync");
+    for (int round = 0; round < rounds; round++) {
+        for (uint32_t index : dirty) {
+            Particle p = grid.atUnchecked(index % size, index / size);
+            massSum += p.isEmpty() ? 0 : p.mass + p.velocity_y;
+            metrics.recordOperation();
+        }
+    }
+    metrics.printResults();
+    std::cout << "Checksum: " << massSum << "\n";
+}
+
+// 3x3 neighbourhood reads, as in the kernels and getValidNeighbors()
+template<typename GridT>
+void benchNeighbourhood(const std::string& name, uint32_t size, int passes) {
+    GridT grid(size, size);
+    fillRain(grid, 42);
+    grid.clearDirtyStates();
+    uint64_t occupied = 0;
+    
+    auto visit = [&](uint32_t x, uint32_t y) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                occupied += !grid.atUnchecked(x + dx, y + dy).isEmpty();
+            }
+        }
+    };
+    
+    PerformanceMetrics rowMetrics(name + " 3x3 Neighbourhood, row order");
+    for (int pass = 0; pass < passes; pass++) {
+        for (uint32_t y = 1; y + 1 < size; y++) {
+            for (uint32_t x = 1; x + 1 < size; x++) {
+                visit(x, y);
+            }
+            rowMetrics.recordOperations(size - 2);
+        }
+    }
+    rowMetrics.printResults();
+    
+    // Chunk by chunk, as the checkerboard update walks the grid
+    PerformanceMetrics metrics(name + " 3x3 Neighbourhood, chunk order");
+    const uint32_t chunk = ChunkTracker::CHUNK_SIZE;
+    for (int pass = 0; pass < passes; pass++) {
+        for (uint32_t cy = 0; cy < size; cy += chunk) {
+            for (uint32_t cx = 0; cx < size; cx += chunk) {
+                for (uint32_t y = std::max(cy, 1u); y < std::min(cy + chunk, size - 1); y++) {
+                    for (uint32_t x = std::max(cx, 1u); x < std::min(cx + chunk, size - 1); x++) {
+                        visit(x, y);
+                    }
+                }
+            }
+        }
+        metrics.recordOperations(static_cast<size_t>(size - 2) * (size - 2));
+    }
+    metrics.printResults();
+    std::cout << "Checksum: " << occupied << "\n";
+}
+
+// Linear row reads through the row-span helper
+template<typename GridT>
+void benchRowSpans(const std::string& name, uint32_t size, int passes) {
+    GridT grid(size, size);
+    fillRain(grid, 42);
+    grid.clearDirtyStates();
+    uint64_t mass = 0;
+    
+    PerformanceMetrics metrics(name + " Row Spans");
+    for (int pass = 0; pass < passes; pass++) {
+        for (uint32_t y = 0; y < size; y++) {
+            grid.forEachInRow(y, 0, size - 1, [&](uint32_t, const Particle& p) {
+                mass += p.mass;
+            });
+            metrics.recordOperations(size);
+        }
+    }
+    metrics.printResults();
+    std::cout << "Checksum: " << mass << "\n";
+}
+
+// The vector-returning neighbour query the grid used to expose
+std::vector<std::pair<uint32_t, uint32_t>> legacyNeighbors(const Grid& grid, uint32_t x, uint32_t y) {
+    static const int dx[] = {-1, 1, 0, 0, -1, -1, 1, 1};
+    static const int dy[] = {0, 0, -1, 1, -1, 1, -1, 1};
+    
+    std::vector<std::pair<uint32_t, uint32_t>> neighbors;
+    neighbors.reserve(8);
+    for (int i = 0; i < 8; ++i) {
+        int nx = static_cast<int>(x) + dx[i];
+        int ny = static_cast<int>(y) + dy[i];
+        if (nx >= 0 && nx < static_cast<int>(grid.getWidth()) &&
+            ny >= 0 && ny < static_cast<int>(grid.getHeight())) {
+            neighbors.emplace_back(nx, ny);
+        }
+    }
+    return neighbors;
+}
+
+// One neighbour query per cell, counting heap allocations per query
+template<typename QueryFn>
+void benchNeighborQuery(const std::string& name, Grid& grid, int passes, QueryFn&& query) {
+    uint32_t size = grid.getWidth();
+    uint64_t occupied = 0;
+    
+    PerformanceMetrics metrics(name);
+    size_t before = g_allocations.load(std::memory_order_relaxed);
+    for (int pass = 0; pass < passes; pass++) {
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                occupied += query(x, y);
+            }
+            metrics.recordOperations(size);
+        }
+    }
+    size_t allocations = g_allocations.load(std::memory_order_relaxed) - before;
+    metrics.printResults();
+    std::cout << "Allocations/query: " << std::setprecision(3)
+              << static_cast<double>(allocations) / (static_cast<double>(passes) * size * size)
+              << "\nChecksum: " << occupied << "\n";
+}
+
+void testNeighborQueries() {
+    std::cout << "\n=== Neighbour Queries (1000x1000, rain) ===\n";
+    Grid grid(1000, 1000);
+    fillRain(grid, 42);
+    GridOperations ops(grid);
+    
+    benchNeighborQuery("Neighbours: std::vector (previous API)", grid, 5, [&](uint32_t x, uint32_t y) {
+        uint32_t n = 0;
+        for (auto [nx, ny] : legacyNeighbors(grid, x, y)) {
+            n += grid.isOccupied(nx, ny);
+        }
+        return n;
+    });
+    benchNeighborQuery("Neighbours: NeighborRange (getNeighbors)", grid, 5, [&](uint32_t x, uint32_t y) {
+        uint32_t n = 0;
+        for (auto [nx, ny] : ops.getNeighbors(x, y)) {
+            n += grid.isOccupied(nx, ny);
+        }
+        return n;
+    });
+    benchNeighborQuery("Neighbours: forEachNeighbor", grid, 5, [&](uint32_t x, uint32_t y) {
+        uint32_t n = 0;
+        grid.forEachNeighbor(x, y, [&](uint32_t nx, uint32_t ny) {
+            n += grid.isOccupied(nx, ny);
+        });
+        return n;
+    });
+}
+
+// One full-grid pass summing masses through an iteration form
+template<typename PassFn>
+void benchCellPass(const std::string& name, Grid& grid, int passes, PassFn&& pass) {
+    uint64_t cells = static_cast<uint64_t>(grid.getWidth()) * grid.getHeight();
+    uint64_t mass = 0;
+    
+    PerformanceMetrics metrics(name);
+    for (int i = 0; i < passes; i++) {
+        mass += pass();
+        metrics.recordOperations(cells);
+    }
+    metrics.printResults();
+    std::cout << "Checksum: " << mass << "\n";
+}
+
+void testCellIteration() {
+    std::cout << "\n=== Cell Iteration (2048x2048, rain) ===\n";
+    Grid grid(2048, 2048);
+    fillRain(grid, 42);
+    
+    benchCellPass("forEachCell: std::function", grid, 10, [&]() {
+        uint64_t mass = 0;
+        std::function<void(uint32_t, uint32_t, Particle&)> fn = [&](uint32_t, uint32_t, Particle& p) {
+            mass += p.mass;
+        };
+        grid.forEachCell(fn);
+        return mass;
+    });
+    benchCellPass("forEachCell: template", grid, 10, [&]() {
+        uint64_t mass = 0;
+        grid.forEachCell([&](uint32_t, uint32_t, Particle& p) { mass += p.mass; });
+        return mass;
+    });
+    benchCellPass("forEachRowSpan", grid, 10, [&]() {
+        uint64_t mass = 0;
+        grid.forEachRowSpan([&](uint32_t, uint32_t, PlaneSpan<Particle> row) {
+            for (const Particle& p : row) mass += p.mass;
+        });
+        return mass;
+    });
+    benchCellPass("parallelForEachRowSpan", grid, 10, [&]() {
+        std::vector<uint64_t> rows(grid.getHeight(), 0);
+        grid.parallelForEachRowSpan([&](uint32_t, uint32_t y, PlaneSpan<Particle> row) {
+            uint64_t mass = 0;
+            for (const Particle& p : row) mass += p.mass;
+            rows[y] = mass;
+        });
+        return std::accumulate(rows.begin(), rows.end(), uint64_t(0));
+    });
+}
+
+// Per-frame spatial index build and per-cell lookups: the dense counting
+// sort index against inserting every particle into the SpatialHash
+void testCellIndex() {
+    const uint32_t size = 512;
+    const int frames = 20;
+    const uint32_t queries = 1000000;
+    std::cout << "\n=== Spatial Index Rebuild (" << size << "x" << size << ", rain) ===\n";
+    Grid grid(size, size);
+    fillRain(grid, 42);
+    
+    CellIndex index(grid);
+    PerformanceMetrics rebuild("CellIndex rebuild (particles)");
+    for (int i = 0; i < frames; i++) {
+        index.rebuild(grid);
+        rebuild.recordOperations(index.size());
+    }
+    rebuild.printResults();
+    
+    SpatialHash hash;
+    PerformanceMetrics insert("SpatialHash insert (particles)");
+    grid.forEachCell([&](uint32_t x, uint32_t y, Particle& p) {
+        if (!p.isEmpty()) {
+            hash.insert(ParticleRef(&grid, x, y), x, y);
+            insert.recordOperation();
+        }
+    });
+    insert.printResults();
+    
+    std::mt19937 rng(7);
+    std::vector<std::pair<uint32_t, uint32_t>> points(queries);
+    for (auto& point : points) {
+        point = {rng() % size, rng() % (size / 2)};
+    }
+    
+    uint64_t found = 0;
+    PerformanceMetrics dense("CellIndex query");
+    for (auto [x, y] : points) {
+        found += index.query(x, y).size();
+    }
+    dense.recordOperations(queries);
+    dense.printResults();
+    std::cout << "Avg results/query: " << static_cast<double>(found) / queries << "\n";
+    
+    found = 0;
+    PerformanceMetrics hashed("SpatialHash query");
+    for (uint32_t i = 0; i < queries / 100; i++) {
+        found += hash.query(points[i].first, points[i].second).size();
+    }
+    hashed.recordOperations(queries / 100);
+    hashed.printResults();
+    std::cout << "Avg results/query: " << static_cast<double>(found) / (queries / 100)
+              << " (bucket collisions included)\n";
+}
+
+void testFlatSpatialHash() {
+    const uint32_t particles = 1000000;
+    const uint32_t world = 1u << 20;  // Sparse 1M x 1M world
+    std::cout << "\n=== Chained vs Flat Spatial Hash (" << particles << " particles, "
+              << world << "x" << world << " world) ===\n";
+    Grid grid(1000, 1000);  // Distinct refs; the hash indexes each once
+    std::mt19937 rng(11);
+    std::vector<std::pair<uint32_t, uint32_t>> points(particles);
+    for (auto& point : points) {
+        point = {rng() % world, rng() % world};
+    }
+    
+    // SpatialHash indexes particles at their own grid positions. With
+    // 1-cell buckets the full grid has the sparse world's profile: about a
+    // million cells of one particle each.
+    std::vector<ParticleRef> refs;
+    refs.reserve(particles);
+    for (uint32_t i = 0; i < particles; i++) {
+        refs.emplace_back(&grid, i % 1000, i / 1000);
+    }
+    std::shuffle(refs.begin(), refs.end(), rng);
+    SpatialHash chained(grid, 1);
+    PerformanceMetrics chainedInsert("SpatialHash insert");
+    for (const ParticleRef& ref : refs) {
+        chained.insert(ref, ref.getX(), ref.getY());
+    }
+    chainedInsert.recordOperations(particles);
+    chainedInsert.printResults();
+    
+    FlatSpatialHash flat;
+    PerformanceMetrics flatInsert("FlatSpatialHash insert");
+    for (uint32_t i = 0; i < particles; i++) {
+        flat.insert(ParticleRef(&grid, i % 1000, i / 1000), points[i].first, points[i].second);
+    }
+    flatInsert.recordOperations(particles);
+    flatInsert.printResults();
+    
+    uint64_t found = 0;
+    PerformanceMetrics chainedQuery("SpatialHash query");
+    for (uint32_t i = 0; i < particles / 1000; i++) {
+        found += chained.query(refs[i].getX(), refs[i].getY()).size();
+    }
+    chainedQuery.recordOperations(particles / 1000);
+    chainedQuery.printResults();
+    std::cout << "Avg results/query: " << static_cast<double>(found) / (particles / 1000)
+              << " (bucket collisions included)\n";
+    
+    found = 0;
+    PerformanceMetrics flatQuery("FlatSpatialHash query");
+    for (auto [x, y] : points) {
+        found += flat.query(x, y).size();
+    }
+    flatQuery.recordOperations(particles);
+    flatQuery.printResults();
+    std::cout << "Avg results/query: " << static_cast<double>(found) / particles << "\n";
+    
+    FlatSpatialHash::ProbeStats stats = flat.getProbeStats();
+    std::cout << "Cells: " << stats.size << ", capacity " << stats.capacity
+              << ", load " << std::setprecision(3) << stats.load_factor
+              << ", displaced " << stats.displaced
+              << ", avg probe " << stats.avg_probe << " groups\n";
+    for (size_t i = 0; i < stats.probe_histogram.size(); i++) {
+        std::cout << "  " << i + 1 << " group(s): " << stats.probe_histogram[i] << "\n";
+    }
+}
+
+// One falling step over the whole grid through the connector, bottom-up
+size_t fallStep(GridSpatialConnector& connector, uint32_t size) {
+    size_t moves = 0;
+    for (uint32_t y = size - 1; y-- > 0;) {
+        for (uint32_t x = 0; x < size; x++) {
+            if (!connector.isEmpty(x, y) && connector.isEmpty(x, y + 1)) {
+                moves += connector.moveParticle(x, y, x, y + 1);
+            }
+        }
+    }
+    return moves;
+}
+
+void testIncrementalSync() {
+    const uint32_t size = 1000;
+    const int frames = 10;
+    std::cout << "\n=== Spatial Hash Sync (" << size << "x" << size << ", rain, "
+              << frames << " frames) ===\n";
+    
+    Grid grid(size, size);
+    SpatialHash hash;
+    GridSpatialConnector connector(grid, hash);
+    fillRain(grid, 42);
+    size_t particles = 0;
+    grid.forEachCell([&](uint32_t x, uint32_t y, Particle& p) {
+        if (!p.isEmpty()) {
+            connector.getDeltaLog().recordSpawn(y * size + x);
+            particles++;
+        }
+    });
+    connector.update();
+    grid.clearDirtyStates();
+    connector.resetMetrics();
+    
+    // Delta sync: net changes of the frame's moves
+    size_t moves = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        moves += fallStep(connector, size);
+        connector.update();
+        grid.clearDirtyStates();
+    }
+    auto metrics = connector.getMetrics();
+    std::cout << "Moves: " << moves << ", net changes applied: " << metrics.updates_processed << "\n";
+    std::cout << "Delta sync (μs/frame): " << metrics.total_sync_time.count() / frames << "\n";
+    std::cout << "Hash entries: " << hash.size() << " for " << particles << " particles\n";
+    
+    // Previous scheme for comparison: re-insert every occupied dirty cell
+    SpatialHash rescan;
+    size_t reinserted = 0;
+    std::chrono::microseconds rescanTime{0};
+    for (int frame = 0; frame < frames; frame++) {
+        fallStep(connector, size);
+        connector.discardDeltas();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t index : grid.getDirtyIndices()) {
+            uint32_t x = index % size;
+            uint32_t y = index / size;
+            if (!grid.atUnchecked(x, y).isEmpty()) {
+                rescan.insert(ParticleRef(&grid, x, y), x, y);
+                reinserted++;
+            }
+        }
+        rescanTime += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        grid.clearDirtyStates();
+    }
+    std::cout << "Dirty re-insert sync (μs/frame): " << rescanTime.count() / frames
+              << ", " << reinserted << " inserts\n";
+    std::cout << "Hash entries: " << rescan.size() << " (vacated cells never removed)\n";
+}
+
+void testEraser() {
+    const uint32_t size = 1000;
+    const int radius = 20;
+    std::cout << "\n=== Eraser on a full world (" << size << "x" << size << ", radius "
+              << radius << ") ===\n";
+    
+    Grid grid(size, size);
+    SpatialHash hash;
+    GridSpatialConnector connector(grid, hash);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            connector.addParticle(x, y, Particle(ParticleType::SAND));
+        }
+    }
+    connector.update();
+    grid.clearDirtyStates();
+    connector.resetMetrics();
+    
+    // One brush dab per frame along rows, as SimulationEngine::eraseParticlesInRadius()
+    size_t erased = 0;
+    int frames = 0;
+    for (int cy = radius; cy < static_cast<int>(size); cy += 2 * radius) {
+        for (int cx = radius; cx < static_cast<int>(size); cx += radius) {
+            for (int dy = -radius; dy <= radius; dy++) {
+                for (int dx = -radius; dx <= radius; dx++) {
+                    uint32_t x = cx + dx;
+                    uint32_t y = cy + dy;
+                    if (dx * dx + dy * dy <= radius * radius && x < size && y < size &&
+                        !connector.isEmpty(x, y)) {
+                        connector.removeParticle(x, y);
+                        erased++;
+                    }
+                }
+            }
+            connector.update();
+            grid.clearDirtyStates();
+            frames++;
+        }
+    }
+    auto metrics = connector.getMetrics();
+    std::cout << "Erased: " << erased << " particles in " << frames << " dabs\n";
+    std::cout << "Removal sync (μs/dab): " << metrics.total_sync_time.count() / frames << "\n";
+    std::cout << "Hash entries: " << hash.size() << " for "
+              << static_cast<size_t>(size) * size - erased << " particles\n";
+    
+    // Remove-only workload straight on the hash: every particle, one by one
+    SpatialHash direct;
+    std::vector<ParticleRef> refs;
+    refs.reserve(static_cast<size_t>(size) * size);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            refs.emplace_back(&grid, x, y);
+        }
+    }
+    direct.batchUpdate(refs);
+    PerformanceMetrics removeAll("SpatialHash remove, 1M particles");
+    size_t removed = 0;
+    for (const ParticleRef& ref : refs) {
+        removed += direct.remove(ref, ref.getX(), ref.getY());
+    }
+    removeAll.recordOperations(removed);
+    removeAll.printResults();
+    std::cout << "Remaining entries: " << direct.size() << "\n";
+}
+
+void testZeroCopyQueries() {
+    const uint32_t size = 1000;
+    const int lookups = 50000;
+    std::cout << "\n=== Copying vs Zero-Copy Queries (" << size << "x" << size << ", rain, "
+              << lookups << " lookups) ===\n";
+    
+    Grid grid(size, size);
+    SpatialHash hash;
+    GridSpatialConnector connector(grid, hash);
+    fillRain(grid, 42);
+    grid.forEachCell([&](uint32_t x, uint32_t y, Particle& p) {
+        if (!p.isEmpty()) {
+            connector.getDeltaLog().recordSpawn(y * size + x);
+        }
+    });
+    connector.update();
+    QuerySystem queries(hash);
+    
+    std::mt19937 rng(3);
+    std::vector<std::pair<uint32_t, uint32_t>> points(lookups);
+    for (auto& point : points) {
+        point = {rng() % size, rng() % (size / 2)};
+    }
+    
+    // Single cells: bucket copy (and cache copy) vs in-place visit
+    uint64_t found = 0;
+    size_t allocations = g_allocations.load();
+    PerformanceMetrics copying("SpatialHash::query (copy)");
+    for (const auto& point : points) {
+        found += hash.query(point.first, point.second).size();
+    }
+    copying.recordOperations(lookups);
+    copying.printResults();
+    std::cout << "Particles: " << found << ", allocations: " << g_allocations.load() - allocations << "\n";
+    
+    found = 0;
+    allocations = g_allocations.load();
+    PerformanceMetrics visiting("SpatialHash::forEachInCell");
+    for (const auto& point : points) {
+        hash.forEachInCell(point.first, point.second, [&](const ParticleRef&) { found++; });
+    }
+    visiting.recordOperations(lookups);
+    visiting.printResults();
+    std::cout << "Particles: " << found << " (own cell only), allocations: "
+              << g_allocations.load() - allocations << "\n";
+    
+    // Radius 6: a 2x2 or 3x3 block of cells per lookup
+    found = 0;
+    allocations = g_allocations.load();
+    PerformanceMetrics radius("QuerySystem::queryRadius");
+    for (const auto& point : points) {
+        found += queries.queryRadius(Vector2D(point.first, point.second), 6.0f).size();
+    }
+    radius.recordOperations(lookups);
+    radius.printResults();
+    std::cout << "Particles: " << found << ", allocations: " << g_allocations.load() - allocations << "\n";
+    
+    found = 0;
+    allocations = g_allocations.load();
+    PerformanceMetrics radiusVisit("QuerySystem::forEachInRadius");
+    for (const auto& point : points) {
+        queries.forEachInRadius(Vector2D(point.first, point.second), 6.0f,
+                                [&](const ParticleRef&) { found++; });
+    }
+    radiusVisit.recordOperations(lookups);
+    radiusVisit.printResults();
+    std::cout << "Particles: " << found << ", allocations: " << g_allocations.load() - allocations << "\n";
+}
+
+void testShardedInsert() {
+    const uint32_t size = 1000;
+    std::cout << "\n=== SpatialHash Batch Insert (" << size * size << " particles) ===\n";
+    Grid grid(size, size);
+    std::vector<ParticleRef> refs;
+    refs.reserve(static_cast<size_t>(size) * size);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            refs.emplace_back(&grid, x, y);
+        }
+    }
+    // Cells in random order, as spawns arrive in a large scene
+    std::shuffle(refs.begin(), refs.end(), std::mt19937(9));
+    
+    {
+        SpatialHash hash;
+        PerformanceMetrics locked("insert() per particle, 1 thread");
+        for (const ParticleRef& ref : refs) {
+            hash.insert(ref, ref.getX(), ref.getY());
+        }
+        locked.recordOperations(refs.size());
+        locked.printResults();
+    }
+    
+    int maxThreads = omp_get_max_threads();
+    int limit = std::max(4, maxThreads);
+    for (int threads = 1; threads <= limit; threads *= 2) {
+        omp_set_num_threads(threads);
+        SpatialHash hash;
+        PerformanceMetrics sharded("batchUpdate(), " + std::to_string(threads) + " thread(s)");
+        hash.batchUpdate(refs);
+        sharded.recordOperations(hash.size());
+        sharded.printResults();
+    }
+    omp_set_num_threads(maxThreads);
+    std::cout << "Hardware threads: " << maxThreads << "\n";
+}
+
+void testInsertLatency() {
+    const uint32_t size = 2048;  // 4M cells, every one inserted
+    std::cout << "\n=== SpatialHash Insert Latency (growth 0 -> " << size * size << ") ===\n";
+    Grid grid(size, size);
+    std::vector<ParticleRef> refs;
+    refs.reserve(static_cast<size_t>(size) * size);
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            refs.emplace_back(&grid, x, y);
+        }
+    }
+    std::shuffle(refs.begin(), refs.end(), std::mt19937(17));
+    
+    SpatialHash hash;
+    std::vector<uint32_t> latencies(refs.size());
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < refs.size(); i++) {
+        auto before = std::chrono::steady_clock::now();
+        hash.insert(refs[i], refs[i].getX(), refs[i].getY());
+        auto after = std::chrono::steady_clock::now();
+        latencies[i] = static_cast<uint32_t>(std::min<int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count(), UINT32_MAX));
+    }
+    auto total = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    // The first insert binds the grid and allocates the slot table
+    std::cout << "Total (ms): " << total << ", entries: " << hash.size()
+              << ", first insert (ns): " << latencies[0] << "\n";
+    latencies.erase(latencies.begin());
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double q) { return latencies[static_cast<size_t>(q * (latencies.size() - 1))]; };
+    std::cout << "Insert latency (ns): p50 " << percentile(0.5) << ", p99 " << percentile(0.99)
+              << ", p99.9 " << percentile(0.999) << ", p99.99 " << percentile(0.9999)
+              << ", max " << latencies.back() << "\n";
+}
+
+void testCellSizeSweep() {
+    const uint32_t size = 1000;
+    const int lookups = 20000;
+    std::cout << "\n=== SpatialHash Cell Size Sweep (" << size << "x" << size << ", rain, "
+              << lookups << " radius queries) ===\n";
+    
+    Grid grid(size, size);
+    fillRain(grid, 42);
+    std::vector<ParticleRef> refs;
+    grid.forEachCell([&](uint32_t x, uint32_t y, Particle& p) {
+        if (!p.isEmpty()) {
+            refs.emplace_back(&grid, x, y);
+        }
+    });
+    
+    // Mostly small brushes and neighbourhoods with a long tail of large ones
+    std::mt19937 rng(25);
+    std::lognormal_distribution<float> radii(std::log(6.0f), 0.6f);
+    std::vector<std::pair<Vector2D, float>> queries(lookups);
+    for (auto& query : queries) {
+        query.first = Vector2D(rng() % size, rng() % size);
+        query.second = std::clamp(radii(rng), 1.0f, 48.0f);
+    }
+    
+    uint32_t best = 0;
+    int64_t bestTime = INT64_MAX;
+    for (uint32_t cellSize : {2u, 4u, 8u, 16u, 32u, 64u}) {
+        SpatialHash hash(grid, cellSize);
+        auto start = std::chrono::steady_clock::now();
+        hash.batchUpdate(refs);
+        auto built = std::chrono::steady_clock::now();
+        
+        QuerySystem system(hash);
+        uint64_t found = 0;
+        for (const auto& query : queries) {
+            system.forEachInRadius(query.first, query.second, [&](const ParticleRef&) { found++; });
+        }
+        auto end = std::chrono::steady_clock::now();
+        
+        auto buildUs = std::chrono::duration_cast<std::chrono::microseconds>(built - start).count();
+        auto queryUs = std::chrono::duration_cast<std::chrono::microseconds>(end - built).count();
+        std::cout << "Cell size " << std::setw(2) << cellSize << ": build (μs) " << buildUs
+                  << ", queries (μs) " << queryUs << ", particles " << found << "\n";
+        if (queryUs < bestTime) {
+            bestTime = queryUs;
+            best = cellSize;
+        }
+    }
+    std::cout << "Fastest queries: cell size " << best << "\n";
+}
+
+void testTiledLayout() {
+    std::cout << "\n=== Row-major vs Morton Tiles (4096x4096, rain) ===\n";
+    benchNeighbourhood<Grid>("Row-major", 4096, 2);
+    benchNeighbourhood<MortonGrid>("Morton", 4096, 2);
+    benchRowSpans<Grid>("Row-major", 4096, 4);
+    benchRowSpans<MortonGrid>("Morton", 4096, 4);
+    benchUpdate<Grid>("Row-major 4096", 4096, 3);
+    benchUpdate<MortonGrid>("Morton 4096", 4096, 3);
+}
+
+void testStorageLayouts() {
+    std::cout << "\n=== AoS vs SoA Grid Storage (1000x1000, rain) ===\n";
+    benchUpdate<Grid>("AoS", 1000, 50);
+    benchUpdate<SoAGrid>("SoA", 1000, 50);
+    benchRender<Grid>("AoS", 1000, 20);
+    benchRender<SoAGrid>("SoA", 1000, 20);
+    benchSync<Grid>("AoS", 1000, 5);
+    benchSync<SoAGrid>("SoA", 1000, 5);
+}
+
 int main() {
     std::cout << "=== Starting Performance Benchmarks ===\n";
     
     testGridPerformance();
     testSpatialHashPerformance();
     testMemoryAllocationPerformance();
+    testStorageLayouts();
+    testTiledLayout();
+    testNeighborQueries();
+    testCellIteration();
+    testCellIndex();
+    testFlatSpatialHash();
+    testIncrementalSync();
+    testEraser();
+    testZeroCopyQueries();
+    testShardedInsert();
+    testInsertLatency();
+    testCellSizeSweep();
     
     auto& monitor = MemoryMonitor::getInstance();
     std::cout << "\n=== Memory Usage Statistics ===\n";
@@ -0,0 +1,642 @@
+#include "SimulationEngine.hpp"
+#include "Scene.hpp"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+void printTestResult(const std::string& testName, bool success) {
+    std::cout << std::setw(30) << std::left << testName 
+              << " : " << (success ? "\033[32mPASSED\033[0m" : "\033[31mFAILED\033[0m") << "\n";
+}
+
+size_t countParticles(const Grid& grid) {
+    size_t count = 0;
+    for (uint32_t y = 0; y < grid.getHeight(); y++) {
+        for (uint32_t x = 0; x < grid.getWidth(); x++) {
+            if (!grid.atUnchecked(x, y).isEmpty()) count++;
+        }
+    }
+    return count;
+}
+
+bool testSandFalls() {
+    std::cout << "\nRunning Sand Fall Tests...\n";
+    bool success = true;
+    
+    SimulationEngine engine(32, 32);
+    engine.addParticle(10, 0, ParticleType::SAND);
+    
+    std::cout << "- Testing sand reaches the floor\n";
+    for (int i = 0; i < 40; i++) {
+        engine.step();
+    }
+    if (engine.getGrid().at(10, 31).type == ParticleType::SAND && countParticles(engine.getGrid()) == 1) {
+        std::cout << "  √ Sand landed on the bottom row\n";
+    } else {
+        std::cout << "  × Sand did not land\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing settled world sleeps\n";
+    engine.step();
+    engine.step();
+    if (engine.getLastStepStats().awake_chunks == 0) {
+        std::cout << "  √ No chunks awake after settling\n";
+    } else {
+        std::cout << "  × Chunks still awake: " << engine.getLastStepStats().awake_chunks << "\n";
+        success = false;
+    }
+    
+    printTestResult("Sand Fall", success);
+    return success;
+}
+
+bool testVelocityFall() {
+    std::cout << "\nRunning Velocity Fall Tests...\n";
+    bool success = true;
+    
+    SimulationEngine engine(16, 200);
+    engine.addParticle(8, 0, ParticleType::SAND);
+    
+    std::cout << "- Testing gravity accumulates into velocity\n";
+    engine.step();
+    engine.step();
+    engine.step();
+    const Particle& falling = engine.getGrid().at(8, 6);
+    if (falling.type == ParticleType::SAND && falling.getVelocityY() == 3) {
+        std::cout << "  √ Sand fell 1+2+3 cells with velocity 3\n";
+    } else {
+        std::cout << "  × Unexpected fall distance or velocity\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing multi-cell moves reach the floor quickly\n";
+    uint64_t moves = 3;
+    int steps = 3;
+    while (engine.getGrid().at(8, 199).isEmpty() && steps < 200) {
+        engine.step();
+        moves += engine.getLastStepStats().moves;
+        steps++;
+    }
+    if (steps <= 30 && moves == static_cast<uint64_t>(steps) &&
+        engine.getGrid().at(8, 199).getVelocityY() == 0) {
+        std::cout << "  √ Landed after " << steps << " steps, one move per step\n";
+    } else {
+        std::cout << "  × Took " << steps << " steps and " << moves << " moves\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing obstacle stops the path\n";
+    SimulationEngine blocked(8, 40);
+    for (uint32_t x = 0; x < 8; x++) {
+        blocked.addParticle(x, 20, ParticleType::STONE);
+    }
+    blocked.addParticle(4, 0, ParticleType::SAND);
+    for (int i = 0; i < 20; i++) {
+        blocked.step();
+    }
+    if (blocked.getGrid().at(4, 19).type == ParticleType::SAND) {
+        std::cout << "  √ Sand stopped on top of the stone\n";
+    } else {
+        std::cout << "  × Sand passed through the obstacle\n";
+        success = false;
+    }
+    
+    printTestResult("Velocity Fall", success);
+    return success;
+}
+
+bool testParticleConservation() {
+    std::cout << "\nRunning Particle Conservation Tests...\n";
+    bool success = true;
+    
+    for (bool parallel : {false, true}) {
+        std::cout << "- Testing " << (parallel ? "parallel" : "serial") << " update\n";
+        Scene scene = Scene::generate("rain", 300, 200, 7);
+        SimulationEngine engine(scene.getWidth(), scene.getHeight());
+        engine.setParallelUpdate(parallel);
+        scene.applyTo(engine);
+        
+        size_t before = countParticles(engine.getGrid());
+        for (int i = 0; i < 100; i++) {
+            engine.step();
+        }
+        size_t after = countParticles(engine.getGrid());
+        
+        if (before == scene.getParticleCount() && before == after) {
+            std::cout << "  √ " << after << " particles conserved\n";
+        } else {
+            std::cout << "  × Particle count changed: " << before << " -> " << after << "\n";
+            success = false;
+        }
+    }
+    
+    printTestResult("Particle Conservation", success);
+    return success;
+}
+
+bool isSettled(const Grid& grid) {
+    uint32_t w = grid.getWidth();
+    uint32_t h = grid.getHeight();
+    for (uint32_t y = 0; y + 1 < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            if (grid.at(x, y).type != ParticleType::SAND) continue;
+            if (grid.at(x, y + 1).isEmpty() ||
+                (x > 0 && grid.at(x - 1, y + 1).isEmpty()) ||
+                (x + 1 < w && grid.at(x + 1, y + 1).isEmpty())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool testSerialParallelMatch() {
+    std::cout << "\nRunning Serial/Parallel Match Tests...\n";
+    bool success = true;
+    
+    // Random sand across several chunk rows and columns
+    SimulationEngine serial(200, 300);
+    SimulationEngine parallel(200, 300);
+    parallel.setParallelUpdate(true);
+    Scene scene = Scene::generate("rain", 200, 300, 11, 0.3f);
+    for (uint32_t y = 0; y < 300; y++) {
+        for (uint32_t x = 0; x < 200; x++) {
+            if (scene.get(x, y) == ParticleType::WATER) {
+                scene.set(x, y, ParticleType::SAND);
+            }
+        }
+    }
+    scene.applyTo(serial);
+    scene.applyTo(parallel);
+    
+    for (int i = 0; i < 400; i++) {
+        serial.step();
+        parallel.step();
+    }
+    
+    std::cout << "- Comparing settled states\n";
+    uint64_t serialHeight = 0;
+    uint64_t parallelHeight = 0;
+    for (uint32_t y = 0; y < 300; y++) {
+        for (uint32_t x = 0; x < 200; x++) {
+            if (!serial.getGrid().at(x, y).isEmpty()) serialHeight += y;
+            if (!parallel.getGrid().at(x, y).isEmpty()) parallelHeight += y;
+        }
+    }
+    double heightRatio = static_cast<double>(parallelHeight) / serialHeight;
+    if (isSettled(serial.getGrid()) && isSettled(parallel.getGrid()) &&
+        countParticles(serial.getGrid()) == countParticles(parallel.getGrid()) &&
+        heightRatio > 0.98 && heightRatio < 1.02) {
+        std::cout << "  √ Both schedules settle to equivalent piles\n";
+    } else {
+        std::cout << "  × Settled states differ (height ratio " << heightRatio << ")\n";
+        success = false;
+    }
+    
+    std::cout << "- Comparing water settling in both schedules\n";
+    // Falling water that stalls at chunk borders spreads sideways into
+    // ledges, which shows in both the settle time and the surface shape
+    Scene rain = Scene::generate("rain", 256, 256, 42, 0.5f);
+    auto settle = [&rain](bool parallelUpdate, int& settleStep, double& meanTop, double& topDeviation) {
+        SimulationEngine engine(256, 256);
+        engine.setParallelUpdate(parallelUpdate);
+        rain.applyTo(engine);
+        
+        // Surface water keeps wandering, so settled means the bulk has
+        // stopped: fewer moves in a step than 1% of the particles
+        settleStep = -1;
+        for (int i = 0; i < 400 && settleStep < 0; i++) {
+            engine.step();
+            if (engine.getLastStepStats().moves * 100 < rain.getParticleCount()) {
+                settleStep = i;
+            }
+        }
+        
+        double sum = 0;
+        double sumSquares = 0;
+        for (uint32_t x = 0; x < 256; x++) {
+            uint32_t top = 0;
+            while (top < 256 && engine.getGrid().at(x, top).isEmpty()) top++;
+            sum += top;
+            sumSquares += static_cast<double>(top) * top;
+        }
+        meanTop = sum / 256;
+        topDeviation = std::sqrt(sumSquares / 256 - meanTop * meanTop);
+    };
+    int serialSettle, parallelSettle;
+    double serialTop, parallelTop, serialDeviation, parallelDeviation;
+    settle(false, serialSettle, serialTop, serialDeviation);
+    settle(true, parallelSettle, parallelTop, parallelDeviation);
+    if (serialSettle >= 0 && parallelSettle >= 0 &&
+        std::abs(parallelSettle - serialSettle) <= std::max(5, serialSettle / 10) &&
+        std::abs(parallelTop - serialTop) < 1.0 &&
+        std::abs(parallelDeviation - serialDeviation) < 1.0) {
+        std::cout << "  √ Settled in " << serialSettle << " and " << parallelSettle
+                  << " steps, surface deviation " << serialDeviation << " and " << parallelDeviation << "\n";
+    } else {
+        std::cout << "  × Settled in " << serialSettle << " vs " << parallelSettle
+                  << " steps, mean top " << serialTop << " vs " << parallelTop
+                  << ", surface deviation " << serialDeviation << " vs " << parallelDeviation << "\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing a grain crossing into an awake chunk row\n";
+    // Water on a shelf and a second falling grain keep chunk (0, 1) awake
+    // across column 11, so a grain crossing y = 64 meets an awake chunk
+    // that must neither stall it nor step it a second time
+    auto trajectory = [](bool parallelUpdate) {
+        SimulationEngine engine(128, 256);
+        engine.setParallelUpdate(parallelUpdate);
+        for (uint32_t x = 15; x < 128; x++) {
+            engine.addParticle(x, 66, ParticleType::STONE);
+            if (x % 2 == 0 && x > 20) {
+                engine.addParticle(x, 65, ParticleType::WATER);
+            }
+        }
+        engine.addParticle(3, 64, ParticleType::SAND);
+        engine.addParticle(11, 50, ParticleType::SAND);
+        
+        std::vector<uint32_t> ys;
+        for (int i = 0; i < 8; i++) {
+            engine.step();
+            for (uint32_t y = 0; y < 256; y++) {
+                if (engine.getGrid().at(11, y).type == ParticleType::SAND) ys.push_back(y);
+            }
+        }
+        return ys;
+    };
+    std::vector<uint32_t> serialPath = trajectory(false);
+    std::vector<uint32_t> parallelPath = trajectory(true);
+    if (serialPath.size() == 8 && serialPath == parallelPath) {
+        std::cout << "  √ Same path in both schedules:";
+        for (uint32_t y : serialPath) std::cout << " " << y;
+        std::cout << "\n";
+    } else {
+        std::cout << "  × Paths differ:";
+        for (uint32_t y : serialPath) std::cout << " " << y;
+        std::cout << " vs";
+        for (uint32_t y : parallelPath) std::cout << " " << y;
+        std::cout << "\n";
+        success = false;
+    }
+    
+    printTestResult("Serial/Parallel Match", success);
+    return success;
+}
+
+bool testActiveListMode() {
+    std::cout << "\nRunning Active List Mode Tests...\n";
+    bool success = true;
+    
+    Scene scene = Scene::generate("rain", 200, 300, 5, 0.3f);
+    for (uint32_t y = 0; y < 300; y++) {
+        for (uint32_t x = 0; x < 200; x++) {
+            if (scene.get(x, y) == ParticleType::WATER) {
+                scene.set(x, y, ParticleType::SAND);
+            }
+        }
+    }
+    
+    // One engine picks the mode before the scene is added (seeded from the
+    // edits), the other switches after (seeded from the occupancy plane)
+    SimulationEngine chunked(200, 300);
+    SimulationEngine editsFirst(200, 300);
+    SimulationEngine switched(200, 300);
+    editsFirst.setUpdateMode(SimulationEngine::UpdateMode::ACTIVE_LIST);
+    scene.applyTo(chunked);
+    scene.applyTo(editsFirst);
+    scene.applyTo(switched);
+    switched.setUpdateMode(SimulationEngine::UpdateMode::ACTIVE_LIST);
+    
+    for (int i = 0; i < 400; i++) {
+        chunked.step();
+        editsFirst.step();
+        switched.step();
+    }
+    
+    std::cout << "- Testing active list settles like the chunk scan\n";
+    auto heightSum = [](const Grid& grid) {
+        uint64_t sum = 0;
+        for (uint32_t y = 0; y < grid.getHeight(); y++) {
+            for (uint32_t x = 0; x < grid.getWidth(); x++) {
+                if (!grid.at(x, y).isEmpty()) sum += y;
+            }
+        }
+        return sum;
+    };
+    double chunkedHeight = static_cast<double>(heightSum(chunked.getGrid()));
+    bool equivalent = true;
+    for (const SimulationEngine* engine : {&editsFirst, &switched}) {
+        double ratio = heightSum(engine->getGrid()) / chunkedHeight;
+        equivalent = equivalent && isSettled(engine->getGrid()) &&
+                     countParticles(engine->getGrid()) == scene.getParticleCount() &&
+                     ratio > 0.98 && ratio < 1.02;
+    }
+    if (equivalent) {
+        std::cout << "  √ Both seeding paths settle to equivalent piles\n";
+    } else {
+        std::cout << "  × Active list settled differently\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing settled particles leave the list\n";
+    if (editsFirst.getLastStepStats().active_cells == 0 && switched.getLastStepStats().active_cells == 0) {
+        std::cout << "  √ No active cells once everything rests\n";
+    } else {
+        std::cout << "  × " << editsFirst.getLastStepStats().active_cells << " cells still active\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing an edit wakes its neighbourhood\n";
+    editsFirst.addParticle(100, 0, ParticleType::SAND);
+    editsFirst.step();
+    uint64_t woken = editsFirst.getLastStepStats().active_cells;
+    if (woken > 0 && woken <= 9 && editsFirst.getGrid().at(100, 0).isEmpty()) {
+        std::cout << "  √ New particle became active and fell\n";
+    } else {
+        std::cout << "  × Edit did not wake the particle (" << woken << " active)\n";
+        success = false;
+    }
+    
+    printTestResult("Active List Mode", success);
+    return success;
+}
+
+bool testUnsettledLiquid() {
+    std::cout << "\nRunning Unsettled Liquid Tests...\n";
+    bool success = true;
+    
+    // A water cell against the left wall on a stone floor can only move
+    // right; a coin flip for the wall leaves it in place for that tick
+    std::cout << "- Testing a blocked liquid keeps its chunk awake\n";
+    const SimulationEngine::UpdateMode modes[] = {
+        SimulationEngine::UpdateMode::CHUNKED,
+        SimulationEngine::UpdateMode::CHECKERBOARD,
+        SimulationEngine::UpdateMode::ACTIVE_LIST
+    };
+    int stuck = 0;
+    for (auto mode : modes) {
+        for (uint64_t seed = 0; seed < 50; seed++) {
+            SimulationEngine engine(64, 16);
+            engine.setUpdateMode(mode);
+            engine.setSeed(seed);
+            for (uint32_t x = 0; x < 64; x++) {
+                engine.addParticle(x, 15, ParticleType::STONE);
+            }
+            engine.addParticle(0, 14, ParticleType::WATER);
+            
+            bool left = false;
+            for (int i = 0; i < 200 && !left; i++) {
+                engine.step();
+                left = engine.getGrid().at(0, 14).isEmpty();
+            }
+            stuck += !left;
+        }
+    }
+    if (stuck == 0) {
+        std::cout << "  √ Water left the wall in every mode and seed\n";
+    } else {
+        std::cout << "  × Water stayed against the wall in " << stuck << " runs\n";
+        success = false;
+    }
+    
+    printTestResult("Unsettled Liquid", success);
+    return success;
+}
+
+bool testSceneLoading() {
+    std::cout << "\nRunning Scene Loading Tests...\n";
+    bool success = true;
+    
+    const char* path = "scene_test.txt";
+    {
+        std::ofstream file(path);
+        file << "% test scene\n";
+        file << "s.w.\n";
+        file << "....\n";
+        file << "#oo#\n";
+    }
+    
+    std::cout << "- Testing text scene parsing\n";
+    Scene scene = Scene::load(path);
+    std::remove(path);
+    if (scene.getWidth() == 4 && scene.getHeight() == 3 && scene.getParticleCount() == 6 &&
+        scene.get(0, 0) == ParticleType::SAND && scene.get(2, 0) == ParticleType::WATER &&
+        scene.get(1, 2) == ParticleType::WOOD && scene.get(3, 2) == ParticleType::STONE) {
+        std::cout << "  √ Scene parsed correctly\n";
+    } else {
+        std::cout << "  × Scene parsing failed\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing scene application\n";
+    SimulationEngine engine(scene.getWidth(), scene.getHeight());
+    scene.applyTo(engine);
+    if (countParticles(engine.getGrid()) == 6 && engine.getGrid().at(0, 0).mass == 100) {
+        std::cout << "  √ Scene applied with default masses\n";
+    } else {
+        std::cout << "  × Scene application failed\n";
+        success = false;
+    }
+    
+    printTestResult("Scene Loading", success);
+    return success;
+}
+
+std::vector<ParticleType> snapshot(const Grid& grid) {
+    std::vector<ParticleType> cells;
+    cells.reserve(static_cast<size_t>(grid.getWidth()) * grid.getHeight());
+    for (uint32_t y = 0; y < grid.getHeight(); y++) {
+        for (uint32_t x = 0; x < grid.getWidth(); x++) {
+            cells.push_back(grid.at(x, y).type);
+        }
+    }
+    return cells;
+}
+
+std::vector<ParticleType> runSeeded(uint64_t seed, bool parallel) {
+    Scene scene = Scene::generate("rain", 300, 200, 11);
+    SimulationEngine engine(scene.getWidth(), scene.getHeight());
+    engine.setParallelUpdate(parallel);
+    engine.setSeed(seed);
+    scene.applyTo(engine);
+    for (int i = 0; i < 150; i++) {
+        engine.step();
+    }
+    return snapshot(engine.getGrid());
+}
+
+bool testDeterministicReplay() {
+    std::cout << "\nRunning Deterministic Replay Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing counter RNG is a pure function of its inputs\n";
+    CounterRng a(1, 5);
+    CounterRng b(1, 5);
+    int heads = 0;
+    for (uint32_t x = 0; x < 10000; x++) {
+        heads += a.coin(x, 3);
+    }
+    if (a.next(7, 9) == b.next(7, 9) && a.next(7, 9) != a.next(9, 7) &&
+        a.next(7, 9) != CounterRng(1, 6).next(7, 9) && a.next(7, 9) != a.next(7, 9, 1) &&
+        heads > 4800 && heads < 5200) {
+        std::cout << "  √ Equal counters match, coin is balanced (" << heads << "/10000)\n";
+    } else {
+        std::cout << "  × Counter RNG is not a stable hash\n";
+        success = false;
+    }
+    
+    for (bool parallel : {false, true}) {
+        std::cout << "- Testing " << (parallel ? "parallel" : "serial") << " replay\n";
+        if (runSeeded(3, parallel) == runSeeded(3, parallel) &&
+            runSeeded(3, parallel) != runSeeded(4, parallel)) {
+            std::cout << "  √ Same seed replays exactly, different seed diverges\n";
+        } else {
+            std::cout << "  × Replay is not reproducible from the seed\n";
+            success = false;
+        }
+    }
+    
+    printTestResult("Deterministic Replay", success);
+    return success;
+}
+
+bool testIncrementalSnapshot() {
+    std::cout << "\nRunning Incremental Snapshot Tests...\n";
+    bool success = true;
+    
+    for (bool parallel : {false, true}) {
+        std::cout << "- Testing " << (parallel ? "parallel" : "serial") << " dirty-rect snapshot\n";
+        Scene scene = Scene::generate("rain", 300, 200, 5);
+        SimulationEngine engine(scene.getWidth(), scene.getHeight());
+        engine.setParallelUpdate(parallel);
+        scene.applyTo(engine);
+        
+        Scene incremental = Scene::capture(engine);
+        size_t maxRects = 0;
+        bool matches = true;
+        for (int i = 0; i < 120; i++) {
+            if (i == 60) {
+                engine.addParticlesInRadius(150, 20, 6, ParticleType::STONE);
+            }
+            engine.step();
+            maxRects = std::max(maxRects, engine.getLastDirtyRects().size());
+            incremental.captureRects(engine, engine.getLastDirtyRects());
+            if (i % 20 == 19) {
+                Scene full = Scene::capture(engine);
+                for (uint32_t y = 0; y < full.getHeight() && matches; y++) {
+                    for (uint32_t x = 0; x < full.getWidth() && matches; x++) {
+                        matches = full.get(x, y) == incremental.get(x, y);
+                    }
+                }
+            }
+        }
+        
+        const ChunkTracker& chunks = engine.getGrid().getChunks();
+        if (matches && maxRects > 0 && maxRects <= chunks.getChunkCount()) {
+            std::cout << "  √ Snapshot from at most " << maxRects << " rects matches the grid\n";
+        } else {
+            std::cout << "  × Incremental snapshot diverged from the grid\n";
+            success = false;
+        }
+    }
+    
+    std::cout << "- Testing snapshot save/load round trip\n";
+    SimulationEngine engine(40, 30);
+    Scene::generate("rain", 40, 30, 9).applyTo(engine);
+    engine.step();
+    const char* path = "snapshot_test.txt";
+    Scene saved = Scene::capture(engine);
+    saved.save(path);
+    Scene loaded = Scene::load(path);
+    std::remove(path);
+    bool same = loaded.getWidth() == saved.getWidth() && loaded.getHeight() == saved.getHeight() &&
+                loaded.getParticleCount() == countParticles(engine.getGrid());
+    for (uint32_t y = 0; y < saved.getHeight() && same; y++) {
+        for (uint32_t x = 0; x < saved.getWidth() && same; x++) {
+            same = loaded.get(x, y) == saved.get(x, y);
+        }
+    }
+    if (same) {
+        std::cout << "  √ Saved snapshot loads back identically\n";
+    } else {
+        std::cout << "  × Snapshot round trip failed\n";
+        success = false;
+    }
+    
+    printTestResult("Incremental Snapshot", success);
+    return success;
+}
+
+bool testSpatialHashSync() {
+    std::cout << "\nRunning Spatial Hash Sync Tests...\n";
+    bool success = true;
+    
+    using Mode = SimulationEngine::UpdateMode;
+    for (Mode mode : {Mode::CHUNKED, Mode::CHECKERBOARD, Mode::ACTIVE_LIST}) {
+        std::cout << "- Testing update mode " << static_cast<int>(mode) << "\n";
+        Scene scene = Scene::generate("rain", 160, 120, 3);
+        SimulationEngine engine(scene.getWidth(), scene.getHeight());
+        engine.setUpdateMode(mode);
+        scene.applyTo(engine);
+        for (int i = 0; i < 40; i++) {
+            engine.step();
+        }
+        
+        // One entry per particle, each at the particle's own cell
+        Grid& grid = engine.getGrid();
+        SpatialHash& hash = engine.getSpatialHash();
+        bool exact = hash.size() == countParticles(grid);
+        for (uint32_t y = 0; y < grid.getHeight() && exact; y++) {
+            for (uint32_t x = 0; x < grid.getWidth() && exact; x++) {
+                if (grid.atUnchecked(x, y).isEmpty()) continue;
+                auto bucket = hash.query(x, y);
+                exact = std::count(bucket.begin(), bucket.end(), ParticleRef(&grid, x, y)) == 1;
+            }
+        }
+        
+        if (exact) {
+            std::cout << "  √ " << hash.size() << " particles indexed exactly once\n";
+        } else {
+            std::cout << "  × Hash holds " << hash.size() << " entries for "
+                      << countParticles(grid) << " particles\n";
+            success = false;
+        }
+    }
+    
+    printTestResult("Spatial Hash Sync", success);
+    return success;
+}
+
+int main() {
+    std::cout << "\n=== Starting Simulation Tests ===\n";
+    
+    std::vector<std::pair<std::string, bool>> results = {
+        {"Sand Fall", testSandFalls()},
+        {"Velocity Fall", testVelocityFall()},
+        {"Particle Conservation", testParticleConservation()},
+        {"Serial/Parallel Match", testSerialParallelMatch()},
+        {"Active List Mode", testActiveListMode()},
+        {"Unsettled Liquid", testUnsettledLiquid()},
+        {"Scene Loading", testSceneLoading()},
+        {"Deterministic Replay", testDeterministicReplay()},
+        {"Incremental Snapshot", testIncrementalSnapshot()},
+        {"Spatial Hash Sync", testSpatialHashSync()}
+    };
+    
+    int totalTests = results.size();
+    int passedTests = std::count_if(results.begin(), results.end(), 
+                                  [](const auto& r) { return r.second; });
+    
+    std::cout << "\n=== Test Summary ===\n";
+    std::cout << "Total Tests    : " << totalTests << "\n";
+    std::cout << "Passed Tests   : " << passedTests << "\n";
+    std::cout << "Failed Tests   : " << (totalTests - passedTests) << "\n";
+    std::cout << "Success Rate   : " << std::fixed << std::setprecision(1) 
+              << (passedTests * 100.0 / totalTests) << "%\n\n";
+    
+    return passedTests == totalTests ? 0 : 1;
+}
@@ -2,9 +2,15 @@
 #include "Grid.hpp"
 #include "SpatialHash.hpp"
 #include "QuerySystem.hpp"
+#include "CellIndex.hpp"
+#include "FlatSpatialHash.hpp"
+#include "grid_spatial_connector.hpp"
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <algorithm>
+#include <random>
+#include <unordered_map>
 
 void printTestResult(const std::string& testName, bool success) {
     std::cout << std::setw(30) << std::left << testName 
@@ -65,6 +71,99 @@ bool testSpatialHashRemoval() {
     return success;
 }
 
+bool contains(const std::vector<ParticleRef>& refs, const ParticleRef& p) {
+    return std::count(refs.begin(), refs.end(), p) == 1;
+}
+
+bool testSlotIndexedRemoval() {
+    std::cout << "\nRunning Slot-Indexed Removal Tests...\n";
+    bool success = true;
+    
+    SpatialHash hash;
+    Grid grid(100, 100);
+    for (uint32_t x = 48; x < 54; x++) {
+        hash.insert(ParticleRef(&grid, x, 48), x, 48);
+    }
+    
+    std::cout << "- Testing removal of missing and removed particles\n";
+    bool missing = !hash.remove(ParticleRef(&grid, 60, 60), 60, 60);
+    bool removed = hash.remove(ParticleRef(&grid, 49, 48), 49, 48);
+    bool twice = !hash.remove(ParticleRef(&grid, 49, 48), 49, 48);
+    auto cell = hash.query(48, 48);
+    bool others = cell.size() == 5 && contains(cell, ParticleRef(&grid, 48, 48)) &&
+                  contains(cell, ParticleRef(&grid, 53, 48));
+    if (missing && removed && twice && hash.size() == 5 && others) {
+        std::cout << "  √ Only indexed particles removed; count stays exact\n";
+    } else {
+        std::cout << "  × Removal miscounted or lost a neighbour\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing relocation within and across cells\n";
+    bool within = hash.relocate(ParticleRef(&grid, 50, 48), ParticleRef(&grid, 50, 49));
+    cell = hash.query(48, 48);
+    bool inPlace = within && cell.size() == 5 && contains(cell, ParticleRef(&grid, 50, 49)) &&
+                   !contains(cell, ParticleRef(&grid, 50, 48));
+    bool across = hash.relocate(ParticleRef(&grid, 48, 48), ParticleRef(&grid, 80, 80));
+    if (inPlace && across && contains(hash.query(80, 80), ParticleRef(&grid, 80, 80)) &&
+        hash.query(48, 48).size() == 4 && hash.size() == 5) {
+        std::cout << "  √ Relocated particles indexed at their new cells\n";
+    } else {
+        std::cout << "  × Relocation left stale entries\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing batched changes reuse freed slots\n";
+    hash.applyChanges({ParticleRef(&grid, 51, 48), ParticleRef(&grid, 52, 48)},
+                      {ParticleRef(&grid, 51, 50)});
+    cell = hash.query(48, 48);
+    if (cell.size() == 3 && hash.size() == 4 && contains(cell, ParticleRef(&grid, 51, 50)) &&
+        contains(cell, ParticleRef(&grid, 53, 48)) && contains(cell, ParticleRef(&grid, 50, 49))) {
+        std::cout << "  √ Removals and insertions applied exactly\n";
+    } else {
+        std::cout << "  × Batched changes corrupted the cell\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing particles of a second grid are rejected\n";
+    Grid other(100, 100);
+    bool rejected = false;
+    try {
+        hash.insert(ParticleRef(&other, 1, 1), 1, 1);
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    if (rejected && hash.size() == 4) {
+        std::cout << "  √ Second grid rejected\n";
+    } else {
+        std::cout << "  × Second grid accepted\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing positions other than the particle's own are rejected\n";
+    size_t mismatched = 0;
+    try {
+        hash.insert(ParticleRef(&grid, 3, 3), 40, 40);
+    } catch (const std::invalid_argument&) {
+        mismatched++;
+    }
+    try {
+        hash.remove(ParticleRef(&grid, 50, 49), 40, 40);
+    } catch (const std::invalid_argument&) {
+        mismatched++;
+    }
+    if (mismatched == 2 && hash.size() == 4 && hash.viewCell(40, 40).empty() &&
+        hash.viewCell(3, 3).empty() && hash.viewCell(50, 49).size() == 3) {
+        std::cout << "  √ Mismatched insert and remove rejected\n";
+    } else {
+        std::cout << "  × Particle indexed under another position\n";
+        success = false;
+    }
+    
+    printTestResult("Slot-Indexed Removal", success);
+    return success;
+}
+
 bool testSpatialHashQuery() {
     std::cout << "\nRunning Spatial Query Tests...\n";
     bool success = true;
@@ -155,14 +254,559 @@ bool testSpatialHashCollisions() {
     return success;
 }
 
+bool testCellIndex() {
+    std::cout << "\nRunning Cell Index Tests...\n";
+    bool success = true;
+    
+    // Width not a multiple of 64 exercises the padded last occupancy word
+    Grid grid(150, 70);
+    uint32_t seed = 7;
+    for (int i = 0; i < 900; i++) {
+        seed = seed * 1103515245u + 12345u;
+        grid.update((seed >> 8) % 150, (seed >> 20) % 70, Particle(ParticleType::SAND));
+    }
+    grid.update(149, 69, Particle(ParticleType::WATER));
+    
+    CellIndex index(grid);
+    index.rebuild(grid);
+    
+    std::cout << "- Testing every cell against a brute-force scan\n";
+    size_t occupied = 0;
+    bool cellsMatch = true;
+    for (uint32_t cy = 0; cy < index.getCellsY(); cy++) {
+        for (uint32_t cx = 0; cx < index.getCellsX(); cx++) {
+            std::vector<uint32_t> expected;
+            uint32_t size = index.getCellSize();
+            for (uint32_t y = cy * size; y < std::min(70u, (cy + 1) * size); y++) {
+                for (uint32_t x = cx * size; x < std::min(150u, (cx + 1) * size); x++) {
+                    if (!grid.at(x, y).isEmpty()) expected.push_back(y * 150 + x);
+                }
+            }
+            auto span = index.cell(cx, cy);
+            cellsMatch = cellsMatch && std::equal(span.begin(), span.end(), expected.begin(), expected.end());
+            occupied += expected.size();
+        }
+    }
+    auto corner = index.query(149, 69);
+    if (cellsMatch && index.size() == occupied && corner.size() > 0 &&
+        corner[corner.size() - 1] == 69 * 150 + 149) {
+        std::cout << "  √ Contiguous, row-major results for all " << index.getCellCount() << " cells\n";
+    } else {
+        std::cout << "  × Index disagrees with the grid\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing rebuild after particles move\n";
+    size_t expectedSize = occupied - 1 + (grid.at(0, 0).isEmpty() ? 1 : 0);
+    grid.update(149, 69, Particle());
+    grid.update(0, 0, Particle(ParticleType::STONE));
+    index.rebuild(grid);
+    bool origin = index.query(0, 0).size() > 0 && index.query(0, 0)[0] == 0;
+    bool moved = index.query(149, 69).size() == corner.size() - 1 && index.size() == expectedSize;
+    if (origin && moved) {
+        std::cout << "  √ Rebuild reflects the new occupancy\n";
+    } else {
+        std::cout << "  × Stale entries after rebuild\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing invalid cell sizes\n";
+    bool threw = false;
+    try {
+        CellIndex bad(grid, 12);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    CellIndex wide(grid, 64);
+    wide.rebuild(grid);
+    int w = 150;
+    int h = 70;
+    CellIndex sized(w, h);
+    sized.rebuild(grid);
+    if (threw && wide.size() == index.size() && wide.getCellsX() == 3 &&
+        sized.getCellCount() == index.getCellCount() && sized.size() == index.size()) {
+        std::cout << "  √ Non power of two rejected, 64-cell lanes and int sizes work\n";
+    } else {
+        std::cout << "  × Cell size handling wrong\n";
+        success = false;
+    }
+    
+    printTestResult("Cell Index", success);
+    return success;
+}
+
+bool testFlatCellMap() {
+    std::cout << "\nRunning Flat Cell Map Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing random inserts and erases against std::unordered_map\n";
+    FlatCellMap map;
+    std::unordered_map<uint64_t, uint32_t> reference;
+    std::mt19937 rng(42);
+    for (uint32_t i = 0; i < 200000; ++i) {
+        uint64_t key = spatial::cellKey(rng() % 512, rng() % 512);
+        if (rng() % 3 == 0) {
+            if (map.erase(key) != (reference.erase(key) == 1)) success = false;
+        } else {
+            auto [value, inserted] = map.tryEmplace(key, i);
+            auto [it, refInserted] = reference.try_emplace(key, i);
+            if (inserted != refInserted || *value != it->second) success = false;
+        }
+    }
+    for (const auto& [key, value] : reference) {
+        const uint32_t* found = map.find(key);
+        if (!found || *found != value) success = false;
+    }
+    if (success && map.size() == reference.size()) {
+        std::cout << "  √ " << map.size() << " keys match after growth and tombstones\n";
+    } else {
+        std::cout << "  × Contents diverge from std::unordered_map\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing probe lengths of a full row of cells\n";
+    FlatCellMap row;
+    for (uint32_t cx = 0; cx < 100000; ++cx) {
+        row.tryEmplace(spatial::cellKey(cx, 7), cx);
+    }
+    FlatCellMap::ProbeStats stats = row.getProbeStats();
+    if (stats.size == 100000 && stats.avg_probe < 1.5 && stats.max_probe <= 16) {
+        std::cout << "  √ Average probe " << stats.avg_probe << " groups, longest "
+                  << stats.max_probe << "\n";
+    } else {
+        std::cout << "  × Clustered keys: average " << stats.avg_probe
+                  << ", longest " << stats.max_probe << "\n";
+        success = false;
+    }
+    
+    printTestResult("Flat Cell Map", success);
+    return success;
+}
+
+bool testFlatSpatialHash() {
+    std::cout << "\nRunning Flat Spatial Hash Tests...\n";
+    bool success = true;
+    
+    FlatSpatialHash hash;
+    Grid grid(100, 100);
+    
+    std::cout << "- Testing cells far beyond the world bounds\n";
+    ParticleRef near(&grid, 10, 10);
+    ParticleRef far(&grid, 20, 20);
+    hash.insert(near, 10, 10);
+    hash.insert(far, 1000000, 3000000);
+    hash.insert(far, 1000000 + SpatialHash::CELL_SIZE * 256, 3000000);
+    if (hash.query(1000000, 3000000).size() == 1 && hash.query(10, 10).size() == 1 &&
+        hash.getCellCount() == 3 && hash.query(5000, 5000).empty()) {
+        std::cout << "  √ Distant cells stay distinct\n";
+    } else {
+        std::cout << "  × Distant cells collided or were lost\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing removal frees empty cells\n";
+    bool removed = hash.remove(far, 1000000, 3000000);
+    bool missing = !hash.remove(far, 1000000, 3000000);
+    if (removed && missing && hash.size() == 2 && hash.getCellCount() == 2 &&
+        hash.query(1000000, 3000000).empty()) {
+        std::cout << "  √ Removed particle and its cell\n";
+    } else {
+        std::cout << "  × Removal left stale entries\n";
+        success = false;
+    }
+    
+    printTestResult("Flat Spatial Hash", success);
+    return success;
+}
+
+bool testShardedBatchInsert() {
+    std::cout << "\nRunning Sharded Batch Insert Tests...\n";
+    bool success = true;
+    
+    SpatialHash hash;
+    Grid grid(300, 300);
+    hash.insert(ParticleRef(&grid, 7, 7), 7, 7);
+    
+    std::cout << "- Testing a large batch with duplicates\n";
+    std::vector<ParticleRef> batch;
+    for (uint32_t y = 0; y < 300; y += 3) {
+        for (uint32_t x = 0; x < 300; x++) {
+            batch.emplace_back(&grid, x, y);
+        }
+    }
+    batch.emplace_back(&grid, 7, 7);    // Already indexed
+    batch.emplace_back(&grid, 10, 30);  // Twice in the batch
+    batch.emplace_back(&grid, 299, 297);
+    hash.batchUpdate(batch);
+    
+    bool exact = hash.size() == 100 * 300 + 1;
+    for (uint32_t y = 0; y < 300 && exact; y++) {
+        for (uint32_t x = 0; x < 300; x++) {
+            size_t expected = (y % 3 == 0 || (x == 7 && y == 7)) ? 1 : 0;
+            auto bucket = hash.query(x, y);
+            if (std::count(bucket.begin(), bucket.end(), ParticleRef(&grid, x, y)) !=
+                static_cast<std::ptrdiff_t>(expected)) {
+                exact = false;
+                break;
+            }
+        }
+    }
+    if (exact) {
+        std::cout << "  √ Every particle indexed exactly once\n";
+    } else {
+        std::cout << "  × Batch lost or duplicated particles (size " << hash.size() << ")\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing merged slots support removal\n";
+    bool removed = hash.remove(ParticleRef(&grid, 150, 150), 150, 150) &&
+                   hash.remove(ParticleRef(&grid, 7, 7), 7, 7);
+    if (removed && hash.size() == 100 * 300 - 1) {
+        std::cout << "  √ Batch-inserted particles removed in place\n";
+    } else {
+        std::cout << "  × Removal after batch insert failed\n";
+        success = false;
+    }
+    
+    printTestResult("Sharded Batch Insert", success);
+    return success;
+}
+
+bool testIncrementalGrowth() {
+    std::cout << "\nRunning Incremental Growth Tests...\n";
+    bool success = true;
+    
+    SpatialHash hash;
+    Grid grid(400, 400);
+    std::vector<ParticleRef> refs;
+    for (uint32_t y = 0; y < 400; y++) {
+        for (uint32_t x = 0; x < 400; x++) {
+            refs.emplace_back(&grid, x, y);
+        }
+    }
+    std::shuffle(refs.begin(), refs.end(), std::mt19937(4));
+    
+    auto indexedOnce = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            size_t found = 0;
+            hash.forEachInCell(refs[i].getX(), refs[i].getY(),
+                               [&](const ParticleRef& p) { found += p == refs[i]; });
+            if (found != 1) return false;
+        }
+        return true;
+    };
+    
+    std::cout << "- Testing single inserts across many bucket splits\n";
+    for (size_t i = 0; i < 100000; i++) {
+        hash.insert(refs[i], refs[i].getX(), refs[i].getY());
+    }
+    if (hash.size() == 100000 && indexedOnce(0, 100000)) {
+        std::cout << "  √ Every particle found after growing from 256 buckets\n";
+    } else {
+        std::cout << "  × Particles lost while splitting\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing removals and batches after growth\n";
+    size_t removed = 0;
+    for (size_t i = 0; i < 100000; i += 2) {
+        removed += hash.remove(refs[i], refs[i].getX(), refs[i].getY());
+    }
+    hash.applyChanges({}, std::vector<ParticleRef>(refs.begin() + 100000, refs.end()));
+    bool oddKept = true;
+    for (size_t i = 1; i < 100000 && oddKept; i += 2) {
+        oddKept = indexedOnce(i, i + 1);
+    }
+    if (removed == 50000 && oddKept && indexedOnce(100000, refs.size()) &&
+        hash.size() == refs.size() - 50000) {
+        std::cout << "  √ Slots stay valid through splits\n";
+    } else {
+        std::cout << "  × Removal or batch failed after splits\n";
+        success = false;
+    }
+    
+    printTestResult("Incremental Growth", success);
+    return success;
+}
+
+bool testWorldBoundsAndCellSize() {
+    std::cout << "\nRunning World Bounds and Cell Size Tests...\n";
+    bool success = true;
+    
+    Grid grid(3000, 100);
+    auto cellHas = [](const SpatialHash& hash, uint32_t x, uint32_t y, const ParticleRef& ref) {
+        bool found = false;
+        hash.forEachInCell(x, y, [&](const ParticleRef& p) { found |= p == ref; });
+        return found;
+    };
+    
+    std::cout << "- Testing bounds derived from a wide grid\n";
+    SpatialHash hash(grid);
+    ParticleRef far(&grid, 2900, 5);
+    ParticleRef near(&grid, 2100, 5);
+    hash.insert(far, 2900, 5);
+    hash.insert(near, 2100, 5);
+    if (hash.getWidth() == 3000 && hash.getHeight() == 100 &&
+        cellHas(hash, 2900, 5, far) && !cellHas(hash, 2900, 5, near) &&
+        cellHas(hash, 2100, 5, near) && !cellHas(hash, 2100, 5, far)) {
+        std::cout << "  √ Cells past 2048 stay distinct\n";
+    } else {
+        std::cout << "  × Cells beyond the old bounds were merged\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing a custom cell size\n";
+    SpatialHash fine(grid, 16);
+    ParticleRef inside(&grid, 15, 15);
+    ParticleRef outside(&grid, 16, 0);
+    fine.insert(inside, 15, 15);
+    fine.insert(outside, 16, 0);
+    QuerySystem query(fine);
+    size_t inRadius = 0;
+    query.forEachInRadius(Vector2D(15.5f, 7.5f), 8.5f, [&](const ParticleRef&) { inRadius++; });
+    if (fine.getCellSize() == 16 && cellHas(fine, 0, 0, inside) &&
+        !cellHas(fine, 0, 0, outside) && inRadius == 2) {
+        std::cout << "  √ 16-unit cells split at x = 16, queries span both\n";
+    } else {
+        std::cout << "  × Cell size not applied\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing bounds given as int sizes\n";
+    int w = 1000;
+    int h = 500;
+    SpatialHash sized(w, h);
+    SpatialHash sizedFine(w, h, 16);
+    if (sized.getWidth() == 1000 && sized.getHeight() == 500 &&
+        sized.getCellSize() == SpatialHash::CELL_SIZE && sizedFine.getCellSize() == 16) {
+        std::cout << "  √ Width, height and cell size taken as given\n";
+    } else {
+        std::cout << "  × Int sizes misread\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing cell sizes that are not a power of two\n";
+    try {
+        SpatialHash invalid(grid, 12);
+        std::cout << "  × Cell size 12 accepted\n";
+        success = false;
+    } catch (const std::invalid_argument&) {
+        std::cout << "  √ Rejected with invalid_argument\n";
+    }
+    
+    printTestResult("World Bounds and Cell Size", success);
+    return success;
+}
+
+bool testZeroCopyQueries() {
+    std::cout << "\nRunning Zero-Copy Query Tests...\n";
+    bool success = true;
+    
+    SpatialHash hash;
+    QuerySystem queries(hash);
+    Grid grid(200, 200);
+    
+    std::cout << "- Testing cell views exclude colliding cells\n";
+    SpatialHash shared;
+    ParticleRef home(&grid, 1, 1);
+    shared.insert(home, 1, 1);
+    // query() copies the whole bucket, so it reveals a cell sharing it
+    uint32_t other_x = 0, other_y = 0;
+    for (uint32_t y = 0; y < 200 && !other_x; y += SpatialHash::CELL_SIZE) {
+        for (uint32_t x = SpatialHash::CELL_SIZE; x < 200; x += SpatialHash::CELL_SIZE) {
+            ParticleRef probe(&grid, x, y);
+            shared.insert(probe, x, y);
+            bool collides = shared.query(1, 1).size() == 2;
+            shared.remove(probe, x, y);
+            if (collides) {
+                other_x = x;
+                other_y = y;
+                break;
+            }
+        }
+    }
+    // Interleave the two cells, then remove and move within them
+    std::vector<ParticleRef> homeCell = {home};
+    std::vector<ParticleRef> otherCell;
+    for (uint32_t i = 0; other_x && i < 6; i++) {
+        ParticleRef mine(&grid, 2 + i, 3);
+        ParticleRef theirs(&grid, other_x + 1 + i, other_y + 2);
+        shared.insert(theirs, theirs.getX(), theirs.getY());
+        shared.insert(mine, mine.getX(), mine.getY());
+        homeCell.push_back(mine);
+        otherCell.push_back(theirs);
+    }
+    if (other_x) {
+        shared.remove(homeCell[2], homeCell[2].getX(), homeCell[2].getY());
+        homeCell.erase(homeCell.begin() + 2);
+        shared.remove(otherCell[0], otherCell[0].getX(), otherCell[0].getY());
+        otherCell.erase(otherCell.begin());
+        ParticleRef moved(&grid, other_x, other_y + 5);
+        shared.relocate(homeCell[1], moved);
+        homeCell.erase(homeCell.begin() + 1);
+        otherCell.push_back(moved);
+    }
+    auto sameSet = [](SpatialHash::CellView view, std::vector<ParticleRef> expected) {
+        return view.size() == expected.size() &&
+               std::all_of(view.begin(), view.end(), [&](const ParticleRef& p) {
+                   return std::count(expected.begin(), expected.end(), p) == 1;
+               });
+    };
+    size_t visited = 0;
+    shared.forEachInCell(1, 1, [&](const ParticleRef&) { visited++; });
+    auto homeView = shared.viewCell(1, 1);
+    if (other_x && sameSet(homeView, homeCell) && sameSet(shared.viewCell(other_x, other_y), otherCell) &&
+        visited == homeCell.size() && shared.query(1, 1).size() == homeCell.size() + otherCell.size()) {
+        std::cout << "  √ Each view is exactly its cell's " << homeView.size() << " particles\n";
+    } else {
+        std::cout << "  × View holds particles of another cell\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing radius and box queries span whole cells\n";
+    ParticleRef east(&grid, 66, 50);
+    hash.insert(east, 66, 50);
+    hash.insert(ParticleRef(&grid, 80, 80), 80, 80);
+    auto inRadius = queries.queryRadius(Vector2D(50, 50), 20.0f);
+    auto inBox = queries.queryBox(Vector2D(40, 40), Vector2D(70, 70));
+    if (inRadius.size() == 1 && inRadius[0] == east && inBox.size() == 1 && inBox[0] == east) {
+        std::cout << "  √ Particles beyond the centre cell found exactly once\n";
+    } else {
+        std::cout << "  × Got " << inRadius.size() << " radius and " << inBox.size() << " box results\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing cached results expire on writes\n";
+    uint32_t epoch = hash.viewCell(66, 50).epoch();
+    hash.insert(ParticleRef(&grid, 52, 52), 52, 52);
+    inRadius = queries.queryRadius(Vector2D(50, 50), 20.0f);
+    if (inRadius.size() == 2 && hash.epoch() != epoch) {
+        std::cout << "  √ New particle seen after the write\n";
+    } else {
+        std::cout << "  × Stale results returned\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing dense regions\n";
+    for (uint32_t i = 0; i < 10; i++) {
+        hash.insert(ParticleRef(&grid, 120 + i % 4, 120 + i / 4), 120 + i % 4, 120 + i / 4);
+    }
+    auto dense = queries.queryDenseRegions(10.0f);
+    if (dense.size() == 10) {
+        std::cout << "  √ Only the crowded cell returned\n";
+    } else {
+        std::cout << "  × Dense region returned " << dense.size() << " particles\n";
+        success = false;
+    }
+    
+    printTestResult("Zero-Copy Queries", success);
+    return success;
+}
+
+// Every particle indexed exactly once, at its own cell, and nothing else
+bool hashMatchesGrid(SpatialHash& hash, Grid& grid) {
+    size_t occupied = 0;
+    bool exact = true;
+    grid.forEachCell([&](uint32_t x, uint32_t y, Particle& p) {
+        if (p.isEmpty()) return;
+        occupied++;
+        auto bucket = hash.query(x, y);
+        exact &= std::count(bucket.begin(), bucket.end(), ParticleRef(&grid, x, y)) == 1;
+    });
+    return exact && hash.size() == occupied;
+}
+
+bool testIncrementalSync() {
+    std::cout << "\nRunning Incremental Spatial Sync Tests...\n";
+    bool success = true;
+    
+    std::cout << "- Testing delta log coalescing\n";
+    ParticleDeltaLog log;
+    log.recordMove(1, 2);
+    log.recordMove(2, 3);
+    log.recordSpawn(7);
+    log.recordDespawn(7);
+    log.recordSpawn(9);
+    log.recordMove(9, 10);
+    log.recordMove(10, 9);
+    std::vector<uint32_t> removed, inserted;
+    log.coalesce(removed, inserted);
+    if (removed == std::vector<uint32_t>{1} && inserted == std::vector<uint32_t>{3, 9}) {
+        std::cout << "  √ Move chains and cancelled spawns reduced to net changes\n";
+    } else {
+        std::cout << "  × Wrong net changes\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing hash after spawns, moves and despawns\n";
+    Grid grid(96, 80);
+    SpatialHash hash;
+    GridSpatialConnector connector(grid, hash);
+    std::mt19937 rng(5);
+    for (int i = 0; i < 1500; i++) {
+        connector.addParticle(rng() % 96, rng() % 80, Particle(ParticleType::SAND));
+    }
+    connector.update();
+    bool spawned = hashMatchesGrid(hash, grid);
+    
+    for (int frame = 0; frame < 20; frame++) {
+        for (int i = 0; i < 400; i++) {
+            uint32_t x = rng() % 95;
+            uint32_t y = rng() % 79;
+            switch (rng() % 6) {
+                case 0: connector.removeParticle(x, y); break;
+                case 1: connector.addParticle(x, y, Particle(ParticleType::WATER)); break;
+                default: connector.moveParticle(x, y, x + rng() % 2, y + 1); break;
+            }
+        }
+        connector.update();
+        grid.clearDirtyStates();
+        if (!hashMatchesGrid(hash, grid)) {
+            std::cout << "  × Hash diverged from the grid at frame " << frame << "\n";
+            success = false;
+            break;
+        }
+    }
+    if (spawned && success) {
+        std::cout << "  √ Hash holds every particle exactly once after 20 frames\n";
+    } else if (!spawned) {
+        std::cout << "  × Spawns not indexed exactly once\n";
+        success = false;
+    }
+    
+    std::cout << "- Testing queries see unsynced edits\n";
+    connector.clear();
+    connector.addParticle(40, 40, Particle(ParticleType::STONE));
+    auto nearby = connector.queryRadius(Vector2D(40, 40), 1.0f);
+    bool found = std::count(nearby.begin(), nearby.end(), ParticleRef(&grid, 40, 40)) > 0;
+    if (hash.size() == 1 && found) {
+        std::cout << "  √ Pending deltas applied before the query\n";
+    } else {
+        std::cout << "  × Query missed a pending edit\n";
+        success = false;
+    }
+    
+    printTestResult("Incremental Spatial Sync", success);
+    return success;
+}
+
 int main() {
     std::cout << "\n=== Starting Spatial Hash Tests ===\n";
     
     std::vector<std::pair<std::string, bool>> results = {
         {"Spatial Hash Insertion", testSpatialHashInsertion()},
         {"Spatial Hash Removal", testSpatialHashRemoval()},
+        {"Slot-Indexed Removal", testSlotIndexedRemoval()},
         {"Spatial Query", testSpatialHashQuery()},
-        {"Hash Collision Handling", testSpatialHashCollisions()}
+        {"Hash Collision Handling", testSpatialHashCollisions()},
+        {"Cell Index", testCellIndex()},
+        {"Flat Cell Map", testFlatCellMap()},
+        {"Flat Spatial Hash", testFlatSpatialHash()},
+        {"Zero-Copy Queries", testZeroCopyQueries()},
+        {"Sharded Batch Insert", testShardedBatchInsert()},
+        {"Incremental Growth", testIncrementalGrowth()},
+        {"World Bounds and Cell Size", testWorldBoundsAndCellSize()},
+        {"Incremental Spatial Sync", testIncrementalSync()}
     };
     
     int totalTests = results.size();